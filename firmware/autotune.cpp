@@ -0,0 +1,175 @@
+/*
+   autotune.cpp : Relay-feedback autotuner for the rate PID
+
+   With the vehicle hovering, each axis in turn has its controller output
+   replaced by a relay that pushes against the measured rate.  The rate settles
+   into a limit cycle whose period Tu and amplitude a give the ultimate gain
+   Ku = 4d / (pi a) for relay amplitude d, and from those the Tyreus-Luyben
+   rules give P, I and D.  These are more conservative than Ziegler-Nichols,
+   whose integral is far too fast for a multirotor rate loop.  Results are converted to pidvals.hpp
+   units and reported over MSP; the gains in flight are not changed.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+#include <string.h>
+
+void Autotune::init(class RC * _rc, class IMU * _imu, uint32_t looptimeUsec)
+{
+    this->rc = _rc;
+    this->imu = _imu;
+
+    this->looptimeSec = looptimeUsec * 1e-6f;
+    this->hysteresis = (int32_t)(CONFIG_AUTOTUNE_HYSTERESIS_DPS / (this->imu->gyroDegreesPerSecondPerCount() * 4) + 0.5f);
+
+    this->state = AUTOTUNE_OFF;
+    this->axis = AXIS_ROLL;
+
+    memset(this->rateP, 0, sizeof(this->rateP));
+    memset(this->rateI, 0, sizeof(this->rateI));
+    memset(this->rateD, 0, sizeof(this->rateD));
+    memset(this->periodMsec, 0, sizeof(this->periodMsec));
+    memset(this->amplitudeDps, 0, sizeof(this->amplitudeDps));
+}
+
+void Autotune::start(void)
+{
+    this->state = AUTOTUNE_WAITING;
+    this->axis = AXIS_ROLL;
+}
+
+void Autotune::stop(void)
+{
+    if (this->state == AUTOTUNE_WAITING || this->state == AUTOTUNE_RUNNING)
+        this->state = AUTOTUNE_OFF;
+}
+
+void Autotune::startAxis(uint32_t startTime)
+{
+    this->axisStart = startTime;
+    this->relay = this->axis == AXIS_YAW ? CONFIG_AUTOTUNE_RELAY_YAW : CONFIG_AUTOTUNE_RELAY_PITCHROLL;
+    this->cycleStart = startTime;
+    this->rateMin = +0x7FFFFFFF;
+    this->rateMax = -0x7FFFFFFF;
+    this->cycles = 0;
+    this->periodSum = 0;
+    this->amplitudeSum = 0;
+}
+
+static uint8_t toGain(float value)
+{
+    return value > 255 ? 255 : (uint8_t)(value + 0.5f);
+}
+
+void Autotune::finishAxis(void)
+{
+    float d = this->axis == AXIS_YAW ? CONFIG_AUTOTUNE_RELAY_YAW : CONFIG_AUTOTUNE_RELAY_PITCHROLL;
+
+    float period = (float)this->periodSum / CONFIG_AUTOTUNE_CYCLES * 1e-6f;
+    float amplitude = (float)this->amplitudeSum / CONFIG_AUTOTUNE_CYCLES;
+
+    // the switching band widens the cycle: take it out of the describing-function amplitude
+    float a2 = amplitude * amplitude - (float)this->hysteresis * this->hysteresis;
+    float a = a2 > 0 ? sqrtf(a2) : amplitude;
+
+    // ultimate gain in axisPID units per gyroADC/4, then Tyreus-Luyben
+    float Ku = 4 * d / ((float)M_PI * a);
+    float Kp = Ku / 2.2f;
+    float Ki = Kp / (2.2f * period);
+    float Kd = Kp * period / 6.3f;
+
+    // Stabilize: P is rate_p/80, I is rate_i/8000 per IMU loop, D is 3*rate_d/32 per IMU loop
+    this->rateP[this->axis] = toGain(Kp * 80);
+    this->rateI[this->axis] = toGain(Ki * 8000 * this->looptimeSec);
+    this->rateD[this->axis] = this->axis == AXIS_YAW ? 0 : toGain(Kd * 32 / 3 / this->looptimeSec);
+
+    this->periodMsec[this->axis] = (uint16_t)(period * 1000 + 0.5f);
+    this->amplitudeDps[this->axis] = (uint16_t)(amplitude * 4 * this->imu->gyroDegreesPerSecondPerCount() + 0.5f);
+}
+
+void Autotune::update(int16_t axisPID[3], uint32_t currentTime)
+{
+    if (this->state != AUTOTUNE_WAITING && this->state != AUTOTUNE_RUNNING)
+        return;
+
+    // any stick input, or closing the throttle, hands the axis back and restarts it later
+    bool centred = !this->rc->throttleIsDown() &&
+        abs(this->rc->command[DEMAND_ROLL])  < CONFIG_AUTOTUNE_DEADBAND &&
+        abs(this->rc->command[DEMAND_PITCH]) < CONFIG_AUTOTUNE_DEADBAND &&
+        abs(this->rc->command[DEMAND_YAW])   < CONFIG_AUTOTUNE_DEADBAND;
+
+    if (!centred) {
+        this->state = AUTOTUNE_WAITING;
+        return;
+    }
+
+    if (this->state == AUTOTUNE_WAITING) {
+        this->startAxis(currentTime + CONFIG_AUTOTUNE_GAP_MSEC * 1000);
+        this->state = AUTOTUNE_RUNNING;
+    }
+
+    if ((int32_t)(currentTime - this->axisStart) < 0)
+        return;
+
+    if (abs(this->imu->angle[AXIS_ROLL]) > CONFIG_AUTOTUNE_MAX_ANGLE || 
+            abs(this->imu->angle[AXIS_PITCH]) > CONFIG_AUTOTUNE_MAX_ANGLE ||
+            currentTime - this->axisStart > CONFIG_AUTOTUNE_TIMEOUT_MSEC * 1000) {
+        this->state = AUTOTUNE_FAILED;
+        return;
+    }
+
+    int32_t rate = this->imu->gyroADC[this->axis] / 4;
+
+    this->rateMin = min(this->rateMin, rate);
+    this->rateMax = max(this->rateMax, rate);
+
+    // relay pushes against the rate: positive output makes positive rate
+    if (this->relay > 0 && rate > this->hysteresis)
+        this->relay = -this->relay;
+
+    else if (this->relay < 0 && rate < -this->hysteresis) {
+
+        this->relay = -this->relay;
+
+        // a cycle ends on each switch back to positive
+        if (this->cycles >= CONFIG_AUTOTUNE_SETTLE_CYCLES) {
+            this->periodSum += currentTime - this->cycleStart;
+            this->amplitudeSum += (this->rateMax - this->rateMin) / 2;
+        }
+
+        this->cycleStart = currentTime;
+        this->rateMin = this->rateMax = rate;
+
+        if (++this->cycles == CONFIG_AUTOTUNE_SETTLE_CYCLES + CONFIG_AUTOTUNE_CYCLES) {
+            this->finishAxis();
+            if (++this->axis == 3)
+                this->state = AUTOTUNE_DONE;
+            else
+                this->startAxis(currentTime + CONFIG_AUTOTUNE_GAP_MSEC * 1000);
+            return;
+        }
+    }
+
+    axisPID[this->axis] = this->relay;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
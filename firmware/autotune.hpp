@@ -0,0 +1,88 @@
+/*
+   autotune.hpp : Relay-feedback autotuner for the rate PID
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define CONFIG_AUTOTUNE_RELAY_PITCHROLL     50      // relay output, in axisPID units
+#define CONFIG_AUTOTUNE_RELAY_YAW           100
+#define CONFIG_AUTOTUNE_HYSTERESIS_DPS      5       // relay switching band, degrees/sec
+#define CONFIG_AUTOTUNE_SETTLE_CYCLES       2       // relay cycles discarded before measuring
+#define CONFIG_AUTOTUNE_CYCLES              4       // relay cycles averaged
+#define CONFIG_AUTOTUNE_GAP_MSEC            1000    // normal control between axes
+#define CONFIG_AUTOTUNE_TIMEOUT_MSEC        3000    // per axis
+#define CONFIG_AUTOTUNE_MAX_ANGLE           250     // tenths of a degree; beyond this the axis fails
+#define CONFIG_AUTOTUNE_DEADBAND            20      // stick command beyond which the pilot has control
+
+typedef enum {
+    AUTOTUNE_OFF,
+    AUTOTUNE_WAITING,       // armed for autotune; waiting for throttle up and centred sticks
+    AUTOTUNE_RUNNING,
+    AUTOTUNE_DONE,
+    AUTOTUNE_FAILED
+} autotuneState_t;
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    class Autotune {
+
+        private:
+
+            class RC  * rc;
+            class IMU * imu;
+
+            float    looptimeSec;       // of the IMU loop, in which pidvals.hpp gains are expressed
+            int32_t  hysteresis;        // gyroADC/4, as in Stabilize
+
+            int16_t  relay;             // current output, +/- relay amplitude
+            uint32_t axisStart;         // relay starts here; normal control until then
+            uint32_t cycleStart;
+            int32_t  rateMin;
+            int32_t  rateMax;
+            uint8_t  cycles;            // completed, including settling cycles
+            uint32_t periodSum;
+            int32_t  amplitudeSum;
+
+            void startAxis(uint32_t startTime);
+            void finishAxis(void);
+
+        public:
+
+            autotuneState_t state;
+            uint8_t  axis;
+
+            // results per axis, in pidvals.hpp units, plus the limit cycle they came from
+            uint8_t  rateP[3];
+            uint8_t  rateI[3];
+            uint8_t  rateD[3];
+            uint16_t periodMsec[3];
+            uint16_t amplitudeDps[3];
+
+            void init(class RC * _rc, class IMU * _imu, uint32_t looptimeUsec);
+
+            // select at arm time
+            void start(void);
+            void stop(void);
+
+            // replaces the controller output on the axis under test
+            void update(int16_t axisPID[3], uint32_t currentTime);
+    };
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,313 @@
+/*
+   blackbox.cpp : On-board flight recorder class implementation
+
+   While armed, every CONFIG_BLACKBOX_RATE_DIVISOR control-loop updates the
+   gyro, accelerometer, attitude, RC commands, PID terms and motor outputs are
+   copied into a RAM ring buffer.  The blackbox task drains the ring to the
+   board's log device (SPI flash, SD card or serial logger) with whatever time
+   the scheduler leaves it, so the control loop never waits on the device.
+   Frames are compressed by BlackboxEncoder.  Each log opens with text header
+   lines naming the fields, and giving their signedness, predictors and
+   encodings, so that a decoder needs no other description.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+// Frame layout: iteration and time, then these groups of 16-bit fields
+typedef struct blackboxGroup_t {
+    const char * name;
+    uint8_t      count;             // 0 for one per motor
+    bool         isSigned;
+    uint8_t      intraPredictor;    // of the first field; the rest of the group predict from it
+    uint8_t      interPredictor;
+} blackboxGroup_t;
+
+// Gyro and accelerometer are noisy, so the average of two frames predicts them better than one
+static const blackboxGroup_t GROUPS[] = {
+    {"gyroADC",   3, true,  BLACKBOX_PREDICT_ZERO,    BLACKBOX_PREDICT_AVERAGE_2},
+    {"accSmooth", 3, true,  BLACKBOX_PREDICT_ZERO,    BLACKBOX_PREDICT_AVERAGE_2},
+    {"angle",     3, true,  BLACKBOX_PREDICT_ZERO,    BLACKBOX_PREDICT_PREVIOUS},
+    {"rcCommand", 4, true,  BLACKBOX_PREDICT_ZERO,    BLACKBOX_PREDICT_PREVIOUS},
+    {"axisP",     3, true,  BLACKBOX_PREDICT_ZERO,    BLACKBOX_PREDICT_PREVIOUS},
+    {"axisI",     3, true,  BLACKBOX_PREDICT_ZERO,    BLACKBOX_PREDICT_PREVIOUS},
+    {"axisD",     3, true,  BLACKBOX_PREDICT_ZERO,    BLACKBOX_PREDICT_PREVIOUS},
+    {"motor",     0, false, BLACKBOX_PREDICT_MIN_PWM, BLACKBOX_PREDICT_AVERAGE_2}
+};
+
+static const uint8_t GROUP_COUNT = sizeof(GROUPS) / sizeof(GROUPS[0]);
+
+static uint16_t putText(char * buf, uint16_t pos, const char * text)
+{
+    while (*text && pos < CONFIG_BLACKBOX_HEADER_BYTES)
+        buf[pos++] = *text++;
+
+    return pos;
+}
+
+static uint16_t putNumber(char * buf, uint16_t pos, uint32_t n)
+{
+    char digits[10];
+    uint8_t k = 0;
+
+    do {
+        digits[k++] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+
+    while (k && pos < CONFIG_BLACKBOX_HEADER_BYTES)
+        buf[pos++] = digits[--k];
+
+    return pos;
+}
+
+void Blackbox::init(IMU * _imu, RC * _rc, Controller * _stabilize, Mixer * _mixer, uint32_t _looptimeUsec)
+{
+    this->imu = _imu;
+    this->rc = _rc;
+    this->stabilize = _stabilize;
+    this->mixer = _mixer;
+    this->looptimeUsec = _looptimeUsec;
+
+    this->head = 0;
+    this->tail = 0;
+    this->overruns = 0;
+    this->frames = 0;
+    this->frameBytes = 0;
+
+    this->logging = false;
+    this->started = false;
+
+    this->available = CONFIG_BLACKBOX && Board::blackboxInit();
+}
+
+uint16_t Blackbox::room(void)
+{
+    return (this->tail - this->head - 1) & (CONFIG_BLACKBOX_RING_BYTES - 1);
+}
+
+bool Blackbox::put(const uint8_t * data, uint16_t count)
+{
+    if (count > this->room())
+        return false;
+
+    uint16_t index = this->head;
+
+    for (uint16_t k=0; k<count; ++k) {
+        this->ring[index] = data[k];
+        index = (index + 1) & (CONFIG_BLACKBOX_RING_BYTES - 1);
+    }
+
+    MEMORY_BARRIER();
+
+    this->head = index;
+
+    return true;
+}
+
+bool Blackbox::putHeader(void)
+{
+    char buf[CONFIG_BLACKBOX_HEADER_BYTES];
+    uint16_t pos = 0;
+
+    pos = putText(buf, pos, "H Product:Hackflight\n");
+    pos = putText(buf, pos, "H Data version:2\n");
+    pos = putText(buf, pos, "H Looptime:");
+    pos = putNumber(buf, pos, this->looptimeUsec);
+    pos = putText(buf, pos, "\nH Divisor:");
+    pos = putNumber(buf, pos, CONFIG_BLACKBOX_RATE_DIVISOR);
+    pos = putText(buf, pos, "\nH I interval:");
+    pos = putNumber(buf, pos, CONFIG_BLACKBOX_INTRA_INTERVAL);
+
+    pos = putText(buf, pos, "\nH Field names:loopIteration,time");
+    for (uint8_t g=0; g<GROUP_COUNT; ++g) {
+        uint8_t count = GROUPS[g].count ? GROUPS[g].count : this->motorCount;
+        for (uint8_t k=0; k<count; ++k) {
+            pos = putText(buf, pos, ",");
+            pos = putText(buf, pos, GROUPS[g].name);
+            pos = putText(buf, pos, "[");
+            pos = putNumber(buf, pos, k);
+            pos = putText(buf, pos, "]");
+        }
+    }
+
+    pos = putText(buf, pos, "\nH Field signed:0,0");
+    for (uint8_t g=0; g<GROUP_COUNT; ++g) {
+        uint8_t count = GROUPS[g].count ? GROUPS[g].count : this->motorCount;
+        for (uint8_t k=0; k<count; ++k)
+            pos = putText(buf, pos, GROUPS[g].isSigned ? ",1" : ",0");
+    }
+
+    // inter frames are all signed varints
+    pos = putText(buf, pos, "\nH Field I predictor:");
+    for (uint8_t k=0; k<this->fieldCount; ++k) {
+        pos = putText(buf, pos, k ? "," : "");
+        pos = putNumber(buf, pos, this->coding[k].intraPredictor);
+    }
+    pos = putText(buf, pos, "\nH Field I encoding:");
+    for (uint8_t k=0; k<this->fieldCount; ++k) {
+        pos = putText(buf, pos, k ? "," : "");
+        pos = putNumber(buf, pos, this->coding[k].intraEncoding);
+    }
+    pos = putText(buf, pos, "\nH Field P predictor:");
+    for (uint8_t k=0; k<this->fieldCount; ++k) {
+        pos = putText(buf, pos, k ? "," : "");
+        pos = putNumber(buf, pos, this->coding[k].interPredictor);
+    }
+    pos = putText(buf, pos, "\n");
+
+    return this->put((uint8_t *)buf, pos);
+}
+
+void Blackbox::start(void)
+{
+    if (!this->available)
+        return;
+
+    this->motorCount = this->mixer->motorCount;
+
+    // iteration and time count up steadily
+    this->fieldCount = 0;
+    for (uint8_t k=0; k<2; ++k) {
+        blackboxFieldCoding_t * c = &this->coding[this->fieldCount++];
+        c->intraPredictor = BLACKBOX_PREDICT_ZERO;
+        c->intraEncoding = BLACKBOX_ENCODE_UNSIGNED_VARINT;
+        c->interPredictor = BLACKBOX_PREDICT_STRAIGHT_LINE;
+        c->group = 0;
+    }
+
+    for (uint8_t g=0; g<GROUP_COUNT; ++g) {
+        uint8_t group = this->fieldCount;
+        uint8_t count = GROUPS[g].count ? GROUPS[g].count : this->motorCount;
+        for (uint8_t k=0; k<count; ++k) {
+            blackboxFieldCoding_t * c = &this->coding[this->fieldCount++];
+            c->intraPredictor = k && GROUPS[g].intraPredictor != BLACKBOX_PREDICT_ZERO ?
+                (uint8_t)BLACKBOX_PREDICT_FIELD_0 : (uint8_t)GROUPS[g].intraPredictor;
+            c->intraEncoding = BLACKBOX_ENCODE_SIGNED_VARINT;
+            c->interPredictor = GROUPS[g].interPredictor;
+            c->group = group;
+        }
+    }
+
+    this->encoder.init(this->coding, this->fieldCount);
+    this->iteration = 0;
+    this->logging = true;
+
+    // the header goes out with the first frame, when there is room for it
+    this->started = false;
+}
+
+void Blackbox::stop(void)
+{
+    if (!this->logging)
+        return;
+
+    this->logging = false;
+
+    if (this->started) {
+        uint8_t end = BLACKBOX_FRAME_END;
+        this->put(&end, 1);
+    }
+}
+
+void Blackbox::log(uint32_t currentTime)
+{
+    if (!this->logging)
+        return;
+
+    // the iteration counts every update, so that a decoder can see what was skipped or lost
+    uint32_t iteration = this->iteration++;
+
+    if (iteration % CONFIG_BLACKBOX_RATE_DIVISOR)
+        return;
+
+    if (!this->started) {
+        this->started = this->putHeader();
+        if (!this->started)
+            return;
+    }
+
+    int32_t values[BLACKBOX_MAX_FIELDS];
+    uint8_t count = 0;
+
+    values[count++] = (int32_t)iteration;
+    values[count++] = (int32_t)currentTime;
+
+    for (uint8_t k=0; k<3; ++k)
+        values[count++] = this->imu->gyroADC[k];
+    for (uint8_t k=0; k<3; ++k)
+        values[count++] = this->imu->accelSmooth[k];
+    for (uint8_t k=0; k<3; ++k)
+        values[count++] = this->imu->angle[k];
+    for (uint8_t k=0; k<4; ++k)
+        values[count++] = this->rc->command[k];
+    for (uint8_t k=0; k<3; ++k)
+        values[count++] = this->stabilize->axisP[k];
+    for (uint8_t k=0; k<3; ++k)
+        values[count++] = this->stabilize->axisI[k];
+    for (uint8_t k=0; k<3; ++k)
+        values[count++] = this->stabilize->axisD[k];
+    for (uint8_t k=0; k<this->motorCount; ++k)
+        values[count++] = this->mixer->motors[k];
+
+    uint8_t frame[BLACKBOX_MAX_FRAME_BYTES];
+
+    uint8_t size = this->encoder.encode(values, frame);
+
+    // the decoder can't follow predictions across a gap, so start again from an intra frame
+    if (!this->put(frame, size)) {
+        this->overruns++;
+        this->encoder.restart();
+        return;
+    }
+
+    this->frames++;
+    this->frameBytes += size;
+}
+
+void Blackbox::update(void)
+{
+    // at most two writes: up to the end of the ring, then from its start
+    for (uint8_t k=0; k<2; ++k) {
+
+        uint16_t head = this->head;
+        uint16_t tail = this->tail;
+
+        if (head == tail)
+            return;
+
+        MEMORY_BARRIER();
+
+        uint16_t count = (head > tail ? head : CONFIG_BLACKBOX_RING_BYTES) - tail;
+
+        uint16_t written = Board::blackboxWrite(&this->ring[tail], count);
+
+        MEMORY_BARRIER();
+
+        this->tail = (tail + written) & (CONFIG_BLACKBOX_RING_BYTES - 1);
+
+        // device busy or full
+        if (written < count)
+            return;
+    }
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,94 @@
+/*
+   blackbox.hpp : On-board flight recorder class header
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define CONFIG_BLACKBOX                 1
+#define CONFIG_BLACKBOX_RATE_DIVISOR    1       // log every Nth control-loop update
+#define CONFIG_BLACKBOX_RING_BYTES      2048    // must be a power of two
+#define CONFIG_BLACKBOX_HEADER_BYTES    1024
+
+// Frame markers, besides the encoder's
+#define BLACKBOX_FRAME_HEADER   'H'     // a line of text describing the frames that follow
+#define BLACKBOX_FRAME_END      'E'     // disarmed
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    // Single producer (the control loop), single consumer (the blackbox task), as in ImuRing.
+    // Each index is written by one side only, so no locking is needed.
+    class Blackbox {
+
+        private:
+
+            class IMU   * imu;
+            class RC    * rc;
+            Controller  * stabilize;
+            class Mixer * mixer;
+
+            uint32_t looptimeUsec;
+
+            uint8_t           ring[CONFIG_BLACKBOX_RING_BYTES];
+            volatile uint16_t head;
+            volatile uint16_t tail;
+
+            bool     started;       // header queued; frames follow
+            bool     logging;       // armed
+            uint8_t  motorCount;    // fixed for the log when it starts
+            uint8_t  fieldCount;
+            uint32_t iteration;     // control-loop updates since the log started
+
+            blackboxFieldCoding_t coding[BLACKBOX_MAX_FIELDS];
+            BlackboxEncoder       encoder;
+
+            uint16_t room(void);
+
+            // all or nothing, so that the log never holds part of a frame
+            bool put(const uint8_t * data, uint16_t count);
+
+            bool putHeader(void);
+
+        public:
+
+            // the board has a log device
+            bool available;
+
+            // frames lost because the log device fell behind
+            volatile uint32_t overruns;
+
+            // frames queued for the log device, and their encoded size, for MSP
+            uint32_t frames;
+            uint32_t frameBytes;
+
+            void init(class IMU * _imu, class RC * _rc, Controller * _stabilize, class Mixer * _mixer,
+                    uint32_t _looptimeUsec);
+
+            // called from arming and disarming
+            void start(void);
+            void stop(void);
+
+            // called from the control loop, after the mixer
+            void log(uint32_t currentTime);
+
+            // called from the blackbox task: drains the ring to the log device
+            void update(void);
+    };
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,122 @@
+/*
+   blackboxencoder.cpp : Predictive frame encoder for the blackbox, class implementation
+
+   Raw 16-bit fields at the control-loop rate would use up the write bandwidth of
+   the flash.  Most fields change little from one frame to the next, so each is
+   written as a varint of its difference from a prediction: zero, the previous
+   value, the average of the previous two, or a straight line through them.  Every
+   CONFIG_BLACKBOX_INTRA_INTERVAL frames an intra frame predicts only from within
+   itself, so that a decoder can start there, and recover after a lost frame.
+   Everything is integer adds and shifts, cheap enough for FPU-less boards.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+static uint8_t putUnsignedVarint(uint8_t * buf, uint8_t pos, uint32_t value)
+{
+    while (value > 0x7F) {
+        buf[pos++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[pos++] = (uint8_t)value;
+
+    return pos;
+}
+
+static uint8_t putSignedVarint(uint8_t * buf, uint8_t pos, int32_t value)
+{
+    return putUnsignedVarint(buf, pos, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+void BlackboxEncoder::init(const blackboxFieldCoding_t * _coding, uint8_t _fieldCount)
+{
+    this->coding = _coding;
+    this->fieldCount = _fieldCount;
+
+    this->restart();
+}
+
+void BlackboxEncoder::restart(void)
+{
+    this->framesSinceIntra = CONFIG_BLACKBOX_INTRA_INTERVAL;
+}
+
+int32_t BlackboxEncoder::predictIntra(uint8_t field, const int32_t * values)
+{
+    switch (this->coding[field].intraPredictor) {
+        case BLACKBOX_PREDICT_FIELD_0:
+            return values[this->coding[field].group];
+        case BLACKBOX_PREDICT_MIN_PWM:
+            return CONFIG_PWM_MIN;
+        default:
+            return 0;
+    }
+}
+
+int32_t BlackboxEncoder::predictInter(uint8_t field)
+{
+    uint32_t a = (uint32_t)this->previous[field];
+    uint32_t b = (uint32_t)this->beforePrevious[field];
+
+    switch (this->coding[field].interPredictor) {
+        case BLACKBOX_PREDICT_PREVIOUS:
+            return (int32_t)a;
+        case BLACKBOX_PREDICT_STRAIGHT_LINE:
+            return (int32_t)(2 * a - b);
+        case BLACKBOX_PREDICT_AVERAGE_2:
+            return ((int32_t)a + (int32_t)b) / 2;
+        default:
+            return 0;
+    }
+}
+
+uint8_t BlackboxEncoder::encode(const int32_t * values, uint8_t * buf)
+{
+    bool intra = this->framesSinceIntra >= CONFIG_BLACKBOX_INTRA_INTERVAL;
+
+    uint8_t pos = 0;
+
+    buf[pos++] = intra ? BLACKBOX_FRAME_INTRA : BLACKBOX_FRAME_INTER;
+
+    for (uint8_t k=0; k<this->fieldCount; ++k) {
+
+        if (intra) {
+            uint32_t residual = (uint32_t)values[k] - (uint32_t)this->predictIntra(k, values);
+            pos = this->coding[k].intraEncoding == BLACKBOX_ENCODE_UNSIGNED_VARINT ?
+                putUnsignedVarint(buf, pos, residual) : putSignedVarint(buf, pos, (int32_t)residual);
+        }
+        else
+            pos = putSignedVarint(buf, pos, (int32_t)((uint32_t)values[k] - (uint32_t)this->predictInter(k)));
+    }
+
+    // straight-line and average predictions from a lone intra frame see no change
+    for (uint8_t k=0; k<this->fieldCount; ++k) {
+        this->beforePrevious[k] = intra ? values[k] : this->previous[k];
+        this->previous[k] = values[k];
+    }
+
+    this->framesSinceIntra = intra ? 1 : this->framesSinceIntra + 1;
+
+    return pos;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
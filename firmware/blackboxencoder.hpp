@@ -0,0 +1,88 @@
+/*
+   blackboxencoder.hpp : Predictive frame encoder for the blackbox, class header
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define CONFIG_BLACKBOX_INTRA_INTERVAL  32      // frames from one intra frame to the next
+
+#define BLACKBOX_MAX_FIELDS             32
+
+// Largest frame: marker, then a five-byte varint for every field
+#define BLACKBOX_MAX_FRAME_BYTES        (1 + 5 * BLACKBOX_MAX_FIELDS)
+
+// Frame markers
+#define BLACKBOX_FRAME_INTRA    'I'     // predicted from within the frame only
+#define BLACKBOX_FRAME_INTER    'P'     // predicted from the frames before it
+
+// Predictors, numbered as in the log header.  Arithmetic is modulo 2^32, and the average
+// rounds toward zero.
+typedef enum {
+    BLACKBOX_PREDICT_ZERO,
+    BLACKBOX_PREDICT_PREVIOUS,
+    BLACKBOX_PREDICT_STRAIGHT_LINE,     // 2 * previous - the one before
+    BLACKBOX_PREDICT_AVERAGE_2,         // (previous + the one before) / 2, for 16-bit fields only
+    BLACKBOX_PREDICT_FIELD_0,           // the first field of the same group, in this frame
+    BLACKBOX_PREDICT_MIN_PWM            // CONFIG_PWM_MIN
+} blackboxPredictor_t;
+
+// Encodings, numbered as in the log header
+typedef enum {
+    BLACKBOX_ENCODE_SIGNED_VARINT,      // zigzag, then as unsigned
+    BLACKBOX_ENCODE_UNSIGNED_VARINT     // seven bits per byte, low first; top bit set on all but the last
+} blackboxEncoding_t;
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    typedef struct blackboxFieldCoding_t {
+        uint8_t intraPredictor;
+        uint8_t intraEncoding;
+        uint8_t interPredictor;         // inter frames always use signed varints
+        uint8_t group;                  // index of the group's first field, for BLACKBOX_PREDICT_FIELD_0
+    } blackboxFieldCoding_t;
+
+    // Each field goes out as a varint of its difference from a prediction: on intra frames from
+    // other fields or constants, on inter frames from the two frames before.
+    class BlackboxEncoder {
+
+        private:
+
+            const blackboxFieldCoding_t * coding;
+            uint8_t  fieldCount;
+
+            int32_t  previous[BLACKBOX_MAX_FIELDS];
+            int32_t  beforePrevious[BLACKBOX_MAX_FIELDS];
+            uint16_t framesSinceIntra;
+
+            int32_t predictIntra(uint8_t field, const int32_t * values);
+            int32_t predictInter(uint8_t field);
+
+        public:
+
+            void init(const blackboxFieldCoding_t * _coding, uint8_t _fieldCount);
+
+            // the next frame is intra: for the start of a log, and after a frame is lost
+            void restart(void);
+
+            // returns the size of the frame written to buf
+            uint8_t encode(const int32_t * values, uint8_t * buf);
+    };
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -32,17 +32,18 @@ extern "C" {
             static uint32_t getMicros();
             static void     imuInit(uint16_t & acc1G, float & gyroScale);
             static void     imuRead(int16_t accADC[3], int16_t gyroADC[3]);
+            static bool     imuStartInterrupt(class ImuRing * ring);
             static void     init(uint32_t & imuLooptimeUsec, uint32_t & calibratingGyroMsec);
             static void     ledSetState(uint8_t id, bool state);
             static uint16_t rcReadPWM(uint8_t chan);
             static bool     rcUseSerial(void);
             static uint16_t rcReadSerial(uint8_t chan);
             static bool     rcSerialReady(void); 
-            static uint8_t  serialAvailableBytes(void);
             static void     serialDebugByte(uint8_t c);
-            static uint8_t  serialReadByte(void);
-            static void     serialWriteByte(uint8_t c);
+            static uint16_t serialRead(uint8_t * data, uint16_t maxCount);    // copies out what has arrived, without waiting
+            static uint16_t serialWrite(const uint8_t * data, uint16_t count); // queues what fits, without waiting
             static void     writeMotor(uint8_t index, uint16_t value);
+            static uint8_t  motorCount(void);   // motor outputs the board can drive
 
             // Helps with simulation
             static void     showArmedStatus(bool armed);
@@ -51,6 +52,28 @@ extern "C" {
             // STM32
             static void     reboot(void);
 
+            // imuStartInterrupt() returns true if the board will push samples into the ring from the 
+            // sensor's data-ready interrupt; otherwise the sample task reads imuRead() into the ring
+
+            // Profiling: a CPU cycle counter where the board has one, otherwise microseconds
+            static uint32_t getTicks(void);
+            static uint32_t getTicksPerMicrosecond(void);
+
+            // Motors: called once writeMotor() has been called for each, so that boards with
+            // digital ESC protocols can send all the frames together
+            static void     completeMotorUpdate(void);
+
+            // Motor speed from ESC telemetry; false if the board has none, or the last reply was corrupt
+            static bool     motorRpm(uint8_t index, uint16_t & rpm);
+
+            // Battery voltage, or 0 if the board doesn't measure it
+            static uint16_t batteryMillivolts(void);
+
+            // Blackbox log device: SPI flash, SD card or a serial logger.  blackboxInit() returns false
+            // if the board has none; blackboxWrite() takes what the device can accept, without waiting
+            static bool     blackboxInit(void);
+            static uint16_t blackboxWrite(const uint8_t * data, uint16_t count);
+
             // Baro
             static bool     baroInit(void);
             static void     baroUpdate(void);
@@ -30,3 +30,10 @@
 #define VSNPRINTF vsnprintf
 #include <stdbool.h>
 #endif
+
+// Keeps a ring buffer's data copy ordered before the index update that publishes it
+#ifdef __GNUC__
+#define MEMORY_BARRIER() __sync_synchronize()
+#else
+#define MEMORY_BARRIER()
+#endif
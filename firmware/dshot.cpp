@@ -0,0 +1,138 @@
+/*
+   dshot.cpp : DShot digital motor protocol, board-independent part
+
+   Each frame is 16 bits sent MSB first: an 11-bit throttle (or command), a
+   telemetry-request bit, and a 4-bit checksum.  A bit is a fixed-period pulse
+   whose high time is 3/8 of the period for a zero and 3/4 for a one, which a
+   board produces by streaming compare values into a PWM channel with DMA.
+
+   In bidirectional DShot the signal is inverted and the checksum complemented,
+   and about 30 usec after each frame the ESC answers on the same wire with its
+   commutation period: 12 bits (3-bit shift, 9-bit mantissa) plus checksum, GCR
+   coded to 20 bits, sent as transitions at 5/4 of the frame bit rate.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+uint16_t dshotThrottle(uint16_t pwm)
+{
+    if (pwm <= CONFIG_PWM_MIN)
+        return 0;
+
+    uint32_t value = DSHOT_MIN_THROTTLE + ((uint32_t)(pwm - CONFIG_PWM_MIN) * (DSHOT_MAX_THROTTLE - DSHOT_MIN_THROTTLE) + 
+            (CONFIG_PWM_MAX - CONFIG_PWM_MIN) / 2) / (CONFIG_PWM_MAX - CONFIG_PWM_MIN);
+
+    return value > DSHOT_MAX_THROTTLE ? DSHOT_MAX_THROTTLE : (uint16_t)value;
+}
+
+uint16_t dshotFrame(uint16_t value, bool telemetry, bool bidirectional)
+{
+    uint16_t packet = (value << 1) | (telemetry ? 1 : 0);
+
+    uint16_t checksum = packet ^ (packet >> 4) ^ (packet >> 8);
+    if (bidirectional)
+        checksum = ~checksum;
+
+    return (packet << 4) | (checksum & 0x0F);
+}
+
+void dshotBits(uint16_t frame, uint16_t zeroTicks, uint16_t oneTicks, uint32_t * buffer, uint8_t stride)
+{
+    for (uint8_t k=0; k<DSHOT_FRAME_BITS; ++k) {
+        buffer[k*stride] = (frame & 0x8000) ? oneTicks : zeroTicks;
+        frame <<= 1;
+    }
+
+    for (uint8_t k=DSHOT_FRAME_BITS; k<DSHOT_BUFFER_BITS; ++k)
+        buffer[k*stride] = 0;
+}
+
+// 5-bit GCR code to nibble; 0xFF for codes that are never sent
+static const uint8_t GCR_DECODE[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x09, 0x0A, 0x0B, 0xFF, 0x0D, 0x0E, 0x0F,
+    0xFF, 0xFF, 0x02, 0x03, 0xFF, 0x05, 0x06, 0x07, 0xFF, 0x00, 0x08, 0x01, 0xFF, 0x04, 0x0C, 0xFF
+};
+
+bool dshotDecodeSamples(const uint32_t * samples, uint16_t count, uint32_t mask, uint32_t & periodUsec)
+{
+    // the reply begins with a falling edge from the idle-high line
+    uint16_t k = 0;
+    while (k < count && (samples[k] & mask))
+        k++;
+    if (k == count)
+        return false;
+
+    // every transition is a one, followed by a zero for each further bit time at the same level
+    uint32_t value = 0;
+    uint8_t  bits = 0;
+    while (bits < DSHOT_TELEMETRY_BITS) {
+
+        bool level = samples[k] & mask;
+        uint16_t start = k;
+        while (k < count && ((samples[k] & mask) != 0) == level)
+            k++;
+
+        // the final run ends in idle-high, so its length is whatever is left
+        uint8_t run = (k == count) ? DSHOT_TELEMETRY_BITS - bits :
+            (uint8_t)((k - start + DSHOT_TELEMETRY_OVERSAMPLE/2) / DSHOT_TELEMETRY_OVERSAMPLE);
+
+        if (run == 0 || bits + run > DSHOT_TELEMETRY_BITS)
+            return false;
+
+        value = (value << run) | (1 << (run - 1));
+        bits += run;
+    }
+
+    // drop the start bit and undo the GCR
+    uint16_t decoded = 0;
+    for (uint8_t n=0; n<4; ++n) {
+        uint8_t nibble = GCR_DECODE[(value >> (15 - 5*n)) & 0x1F];
+        if (nibble == 0xFF)
+            return false;
+        decoded = (decoded << 4) | nibble;
+    }
+
+    uint16_t checksum = decoded ^ (decoded >> 8);
+    checksum ^= checksum >> 4;
+    if ((checksum & 0x0F) != 0x0F)
+        return false;
+
+    uint16_t period = decoded >> 4;
+
+    // longest period the format can carry means stopped
+    periodUsec = (period == 0x0FFF) ? 0 : (uint32_t)(period & 0x1FF) << (period >> 9);
+
+    return true;
+}
+
+uint16_t dshotRpm(uint32_t periodUsec)
+{
+    if (periodUsec == 0)
+        return 0;
+
+    // electrical RPM over pole pairs
+    uint32_t rpm = 60000000 / periodUsec / (CONFIG_MOTOR_POLES / 2);
+
+    return rpm > 65535 ? 65535 : (uint16_t)rpm;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,54 @@
+/*
+   dshot.hpp : DShot digital motor protocol, board-independent part
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define CONFIG_MOTOR_POLES              14      // magnets, for converting electrical to mechanical RPM
+
+#define DSHOT_MIN_THROTTLE              48      // 0 is stop, 1-47 are ESC commands
+#define DSHOT_MAX_THROTTLE              2047
+#define DSHOT_FRAME_BITS                16
+#define DSHOT_BUFFER_BITS               (DSHOT_FRAME_BITS + 2)  // trailing zero-duty bits leave the line idle
+
+#define DSHOT_TELEMETRY_BITS            21      // start bit and 20 GCR bits, each a transition or not
+#define DSHOT_TELEMETRY_OVERSAMPLE      3       // line samples per telemetry bit, for boards that sample the line
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    // PWM microseconds in [CONFIG_PWM_MIN, CONFIG_PWM_MAX] to a throttle value, 0 at the bottom
+    uint16_t dshotThrottle(uint16_t pwm);
+
+    // 11-bit value, telemetry-request bit and checksum; bidirectional frames invert the checksum
+    uint16_t dshotFrame(uint16_t value, bool telemetry, bool bidirectional);
+
+    // Timer compare values for each bit of a frame, for a DMA stream into a PWM channel
+    // (every stride-th word, so that several channels can share one burst-DMA buffer)
+    void dshotBits(uint16_t frame, uint16_t zeroTicks, uint16_t oneTicks, uint32_t * buffer, uint8_t stride);
+
+    // Bidirectional telemetry: line samples taken from just before the reply's first falling edge,
+    // DSHOT_TELEMETRY_OVERSAMPLE per bit, with the line in bit 'mask' of each.  Gives the
+    // commutation period in microseconds, 0 when stopped; false if the reply is corrupt.
+    bool dshotDecodeSamples(const uint32_t * samples, uint16_t count, uint32_t mask, uint32_t & periodUsec);
+
+    // Mechanical RPM from a commutation period
+    uint16_t dshotRpm(uint32_t periodUsec);
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,200 @@
+/*
+   dynnotch.cpp : Gyro notch that follows the dominant vibration peak
+
+   The IMU feeds every raw gyro sample, from the ring or polled once per loop,
+   into a rolling window and through the per-axis notch.  A background task
+   analyzes one axis at a time with a radix-2 FFT, split into slices (load,
+   one slice per butterfly stage, peak search) so no single call costs more
+   than one pass over the window.  The
+   peak is located between bins by parabolic interpolation, smoothed, and the
+   notch retuned without clearing its state.
+
+   In the fixed-point build each stage halves its outputs, so the transform
+   cannot overflow the Q8 samples.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+#include <string.h>
+
+#ifdef FIXED_POINT
+typedef int64_t fftPower_t;
+#define FFT_HALVE(x)    ((x) >> 1)
+#else
+typedef float fftPower_t;
+#define FFT_HALVE(x)    ((x) * 0.5f)
+#endif
+
+enum {
+    SLICE_LOAD = 0,
+    SLICE_BUTTERFLIES   // one slice per stage, then the peak search
+};
+
+static uint8_t bitReverse(uint8_t k, uint8_t bits)
+{
+    uint8_t r = 0;
+    for (uint8_t b=0; b<bits; ++b) {
+        r = (r << 1) | (k & 1);
+        k >>= 1;
+    }
+    return r;
+}
+
+void DynamicNotch::init(float _sampleHz)
+{
+    this->sampleHz = _sampleHz;
+
+    memset(this->history, 0, sizeof(this->history));
+    this->historyIndex = 0;
+
+    this->stages = 0;
+    while ((1 << this->stages) < CONFIG_DYN_NOTCH_FFT_SIZE)
+        this->stages++;
+
+    // Hann window, and twiddles e^(-2 pi i k / N)
+    for (uint8_t k=0; k<CONFIG_DYN_NOTCH_FFT_SIZE; ++k)
+        this->window[k] = FILTER_COEFF(0.5f - 0.5f * cosf(2 * M_PI * k / CONFIG_DYN_NOTCH_FFT_SIZE));
+    for (uint8_t k=0; k<CONFIG_DYN_NOTCH_FFT_SIZE/2; ++k) {
+        this->twiddleCos[k] = FILTER_COEFF(cosf(2 * M_PI * k / CONFIG_DYN_NOTCH_FFT_SIZE));
+        this->twiddleSin[k] = FILTER_COEFF(-sinf(2 * M_PI * k / CONFIG_DYN_NOTCH_FFT_SIZE));
+    }
+
+    for (uint8_t k=0; k<3; ++k) {
+        biquadReset(&this->notch[k]);
+        this->enabled[k] = false;
+        this->centerHz[k] = 0;
+    }
+
+    this->axis = 0;
+    this->slice = SLICE_LOAD;
+}
+
+filterSample_t DynamicNotch::apply(uint8_t _axis, int16_t gyroADC, filterSample_t input)
+{
+    this->history[this->historyIndex][_axis] = gyroADC;
+
+    // the yaw sample is the last of each set
+    if (_axis == 2)
+        this->historyIndex = (this->historyIndex + 1) % CONFIG_DYN_NOTCH_FFT_SIZE;
+
+    return this->enabled[_axis] ? biquadApply(&this->notch[_axis], input) : input;
+}
+
+// Copy the window in bit-reversed order with the mean removed and the Hann taper applied
+void DynamicNotch::load(void)
+{
+    int32_t sum = 0;
+    for (uint8_t k=0; k<CONFIG_DYN_NOTCH_FFT_SIZE; ++k)
+        sum += this->history[k][this->axis];
+    int32_t mean = sum / CONFIG_DYN_NOTCH_FFT_SIZE;
+
+    // oldest sample is the one about to be overwritten
+    uint8_t j = this->historyIndex;
+    for (uint8_t k=0; k<CONFIG_DYN_NOTCH_FFT_SIZE; ++k) {
+        uint8_t r = bitReverse(k, this->stages);
+        this->re[r] = FILTER_MUL(this->window[k], FILTER_SAMPLE(this->history[j][this->axis] - mean));
+        this->im[r] = 0;
+        j = (j + 1) % CONFIG_DYN_NOTCH_FFT_SIZE;
+    }
+}
+
+void DynamicNotch::butterflies(uint8_t stage)
+{
+    uint8_t half = 1 << stage;
+    uint8_t twiddleStep = CONFIG_DYN_NOTCH_FFT_SIZE / (2 * half);
+
+    for (uint8_t start=0; start<CONFIG_DYN_NOTCH_FFT_SIZE; start += 2*half) {
+        for (uint8_t k=0; k<half; ++k) {
+            uint8_t a = start + k;
+            uint8_t b = a + half;
+            filterCoeff_t wr = this->twiddleCos[k * twiddleStep];
+            filterCoeff_t wi = this->twiddleSin[k * twiddleStep];
+            filterSample_t tr = FILTER_MUL(wr, this->re[b]) - FILTER_MUL(wi, this->im[b]);
+            filterSample_t ti = FILTER_MUL(wr, this->im[b]) + FILTER_MUL(wi, this->re[b]);
+            this->re[b] = FFT_HALVE(this->re[a] - tr);
+            this->im[b] = FFT_HALVE(this->im[a] - ti);
+            this->re[a] = FFT_HALVE(this->re[a] + tr);
+            this->im[a] = FFT_HALVE(this->im[a] + ti);
+        }
+    }
+}
+
+void DynamicNotch::findPeak(void)
+{
+    float binHz = this->sampleHz / CONFIG_DYN_NOTCH_FFT_SIZE;
+    uint8_t first = (uint8_t)(CONFIG_DYN_NOTCH_MIN_HZ / binHz) + 1;
+    uint8_t last  = (uint8_t)(CONFIG_DYN_NOTCH_MAX_HZ / binHz);
+    if (last > CONFIG_DYN_NOTCH_FFT_SIZE/2 - 2)
+        last = CONFIG_DYN_NOTCH_FFT_SIZE/2 - 2;
+
+    // a slow polled loop can put the whole band above Nyquist
+    if (first > last)
+        return;
+
+    fftPower_t power[CONFIG_DYN_NOTCH_FFT_SIZE/2];
+    fftPower_t total = 0;
+    uint8_t peak = first;
+
+    for (uint8_t k=first-1; k<=last+1; ++k) {
+        power[k] = (fftPower_t)this->re[k] * this->re[k] + (fftPower_t)this->im[k] * this->im[k];
+        if (k >= first && k <= last) {
+            total += power[k];
+            if (power[k] > power[peak])
+                peak = k;
+        }
+    }
+
+    // a flat spectrum has nothing worth notching
+    if (power[peak] * (last - first + 1) <= total * CONFIG_DYN_NOTCH_SNR)
+        return;
+
+    // parabola through the peak and its neighbours
+    float left = (float)power[peak-1], center = (float)power[peak], right = (float)power[peak+1];
+    float denominator = left - 2 * center + right;
+    float offset = (denominator != 0) ? 0.5f * (left - right) / denominator : 0;
+    float peakHz = (peak + offset) * binHz;
+    peakHz = constrain(peakHz, CONFIG_DYN_NOTCH_MIN_HZ, CONFIG_DYN_NOTCH_MAX_HZ);
+
+    float * c = &this->centerHz[this->axis];
+    *c = this->enabled[this->axis] ? *c + CONFIG_DYN_NOTCH_SMOOTHING * (peakHz - *c) : peakHz;
+
+    biquadSetNotch(&this->notch[this->axis], *c, *c * CONFIG_DYN_NOTCH_CUTOFF_RATIO, this->sampleHz);
+    this->enabled[this->axis] = true;
+}
+
+void DynamicNotch::step(void)
+{
+    if (this->slice == SLICE_LOAD)
+        this->load();
+    else if (this->slice < SLICE_BUTTERFLIES + this->stages)
+        this->butterflies(this->slice - SLICE_BUTTERFLIES);
+    else {
+        this->findPeak();
+        this->axis = (this->axis + 1) % 3;
+        this->slice = SLICE_LOAD;
+        return;
+    }
+
+    this->slice++;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
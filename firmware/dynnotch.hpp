@@ -0,0 +1,74 @@
+/*
+   dynnotch.hpp : Gyro notch that follows the dominant vibration peak
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define CONFIG_DYN_NOTCH_FFT_SIZE       64      // power of two; bins are CONFIG_GYRO_SAMPLE_HZ / size wide
+#define CONFIG_DYN_NOTCH_MIN_HZ         80
+#define CONFIG_DYN_NOTCH_MAX_HZ         450
+#define CONFIG_DYN_NOTCH_CUTOFF_RATIO   0.85f   // lower -3dB point as a fraction of the center
+#define CONFIG_DYN_NOTCH_SNR            10      // peak power over mean band power to accept a peak
+#define CONFIG_DYN_NOTCH_SMOOTHING      0.3f    // fraction of the way to move toward each new peak
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    class DynamicNotch {
+
+        private:
+
+            // rolling window of raw gyro, shared by the three axes
+            int16_t        history[CONFIG_DYN_NOTCH_FFT_SIZE][3];
+            uint8_t        historyIndex;
+
+            // FFT work area and tables
+            filterSample_t re[CONFIG_DYN_NOTCH_FFT_SIZE];
+            filterSample_t im[CONFIG_DYN_NOTCH_FFT_SIZE];
+            filterCoeff_t  window[CONFIG_DYN_NOTCH_FFT_SIZE];
+            filterCoeff_t  twiddleCos[CONFIG_DYN_NOTCH_FFT_SIZE/2];
+            filterCoeff_t  twiddleSin[CONFIG_DYN_NOTCH_FFT_SIZE/2];
+            uint8_t        stages;
+
+            // analysis state: which axis, and which slice of it, runs next
+            uint8_t        axis;
+            uint8_t        slice;
+
+            biquad_t       notch[3];
+            bool           enabled[3];
+            float          sampleHz;
+
+            void load(void);
+            void butterflies(uint8_t stage);
+            void findPeak(void);
+
+        public:
+
+            float          centerHz[3];
+
+            void init(float _sampleHz);
+
+            // called on every gyro sample, from the IMU task
+            filterSample_t apply(uint8_t axis, int16_t gyroADC, filterSample_t input);
+
+            // one slice of analysis, from a background task; a full pass takes log2(size)+2 calls per axis
+            void step(void);
+    };
+
+#ifdef __arm__
+} // extern "C"
+#endif
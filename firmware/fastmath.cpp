@@ -0,0 +1,170 @@
+/*
+   fastmath.cpp : Table and polynomial approximations of libm functions
+
+   Sine is a quarter-wave table with linear interpolation; atan2 reduces to
+   atan on [0,1] and uses the Abramowitz & Stegun 4.4.49 polynomial; inverse
+   square root is the usual exponent trick refined by two Newton steps; pow is
+   exp2(y * log2(x)) with short series for the mantissa and fraction.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+#include <string.h>
+
+#define SIN_TABLE_SIZE 128
+
+// sin(k/128 * pi/2), k = 0..128
+static const float SIN_TABLE[SIN_TABLE_SIZE+1] = {
+    0.0000000f, 0.0122715f, 0.0245412f, 0.0368072f, 0.0490677f, 0.0613207f, 0.0735646f, 0.0857973f,
+    0.0980171f, 0.1102222f, 0.1224107f, 0.1345807f, 0.1467305f, 0.1588581f, 0.1709619f, 0.1830399f,
+    0.1950903f, 0.2071114f, 0.2191012f, 0.2310581f, 0.2429802f, 0.2548657f, 0.2667128f, 0.2785197f,
+    0.2902847f, 0.3020059f, 0.3136817f, 0.3253103f, 0.3368899f, 0.3484187f, 0.3598950f, 0.3713172f,
+    0.3826834f, 0.3939920f, 0.4052413f, 0.4164296f, 0.4275551f, 0.4386162f, 0.4496113f, 0.4605387f,
+    0.4713967f, 0.4821838f, 0.4928982f, 0.5035384f, 0.5141027f, 0.5245897f, 0.5349976f, 0.5453250f,
+    0.5555702f, 0.5657318f, 0.5758082f, 0.5857979f, 0.5956993f, 0.6055110f, 0.6152316f, 0.6248595f,
+    0.6343933f, 0.6438315f, 0.6531728f, 0.6624158f, 0.6715590f, 0.6806010f, 0.6895405f, 0.6983762f,
+    0.7071068f, 0.7157308f, 0.7242471f, 0.7326543f, 0.7409511f, 0.7491364f, 0.7572088f, 0.7651673f,
+    0.7730105f, 0.7807372f, 0.7883464f, 0.7958369f, 0.8032075f, 0.8104572f, 0.8175848f, 0.8245893f,
+    0.8314696f, 0.8382247f, 0.8448536f, 0.8513552f, 0.8577286f, 0.8639729f, 0.8700870f, 0.8760701f,
+    0.8819213f, 0.8876396f, 0.8932243f, 0.8986745f, 0.9039893f, 0.9091680f, 0.9142098f, 0.9191139f,
+    0.9238795f, 0.9285061f, 0.9329928f, 0.9373390f, 0.9415441f, 0.9456073f, 0.9495282f, 0.9533060f,
+    0.9569403f, 0.9604305f, 0.9637761f, 0.9669765f, 0.9700313f, 0.9729400f, 0.9757021f, 0.9783174f,
+    0.9807853f, 0.9831055f, 0.9852776f, 0.9873014f, 0.9891765f, 0.9909026f, 0.9924795f, 0.9939070f,
+    0.9951847f, 0.9963126f, 0.9972905f, 0.9981181f, 0.9987955f, 0.9993224f, 0.9996988f, 0.9999247f,
+    1.0000000f
+};
+
+float fastSin(float x)
+{
+    // position in quarter turns, wrapped to [0,4)
+    float turns = x * (float)(2 / M_PI);
+    turns -= 4 * floorf(turns * 0.25f);
+
+    uint8_t quadrant = (uint8_t)turns;
+    float   position = (turns - quadrant) * SIN_TABLE_SIZE;
+
+    // second and fourth quadrants run the table backwards
+    if (quadrant & 1)
+        position = SIN_TABLE_SIZE - position;
+
+    int16_t index = (int16_t)position;
+    if (index >= SIN_TABLE_SIZE)
+        index = SIN_TABLE_SIZE - 1;
+    float frac = position - index;
+
+    float value = SIN_TABLE[index] + (SIN_TABLE[index+1] - SIN_TABLE[index]) * frac;
+
+    return (quadrant & 2) ? -value : value;
+}
+
+float fastCos(float x)
+{
+    return fastSin(x + (float)(M_PI / 2));
+}
+
+float fastAtan2(float y, float x)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+
+    if (ax == 0 && ay == 0)
+        return 0;
+
+    bool swap = ay > ax;
+    float z  = swap ? ax / ay : ay / ax;
+    float z2 = z * z;
+
+    float angle = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+
+    if (swap)
+        angle = (float)(M_PI / 2) - angle;
+    if (x < 0)
+        angle = (float)M_PI - angle;
+
+    return y < 0 ? -angle : angle;
+}
+
+float fastInvSqrt(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f3759df - (bits >> 1);
+
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+
+    float halfx = 0.5f * x;
+    y = y * (1.5f - halfx * y * y);
+    y = y * (1.5f - halfx * y * y);
+
+    return y;
+}
+
+float fastSqrt(float x)
+{
+    return x > 0 ? x * fastInvSqrt(x) : 0;
+}
+
+float fastPow(float x, float y)
+{
+    if (x <= 0)
+        return 0;
+
+    // x = m * 2^e, with m in [sqrt(1/2), sqrt(2)) to keep the log series short
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int32_t e = (int32_t)((bits >> 23) & 0xFF) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > (float)M_SQRT2) {
+        m *= 0.5f;
+        e++;
+    }
+
+    // ln(m) = 2 atanh(t), t = (m-1)/(m+1), |t| < 0.172
+    float t  = (m - 1) / (m + 1);
+    float t2 = t * t;
+    float lnm = 2 * t * (1 + t2 * (1/3.0f + t2 * (1/5.0f + t2 * (1/7.0f + t2 * (1/9.0f)))));
+
+    float p = y * (e + lnm * (float)M_LOG2E);
+
+    // 2^p = 2^n * 2^f, with f in [-0.5,0.5]
+    float n = floorf(p + 0.5f);
+    float f = (p - n) * (float)M_LN2;
+
+    float scaled = 1 + f * (1 + f * (1/2.0f + f * (1/6.0f + f * (1/24.0f + f * (1/120.0f + f * (1/720.0f))))));
+
+    int32_t exponent = (int32_t)n + 127;
+    if (exponent <= 0)
+        return 0;
+    if (exponent >= 255)
+        return INFINITY;
+
+    uint32_t scale = (uint32_t)exponent << 23;
+    float s;
+    memcpy(&s, &scale, sizeof(s));
+
+    return scaled * s;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
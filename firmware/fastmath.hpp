@@ -0,0 +1,59 @@
+/*
+   fastmath.hpp : Table and polynomial approximations of libm functions
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <math.h>
+
+// Boards without an FPU, where soft-float libm dominates the IMU and baro
+// profiles, can define FAST_MATH to use these in place of libm.  Teensy 3.2
+// has no FPU, so it gets them automatically; the STM32 Makefile sets it.
+#if defined(__MK20DX256__) && !defined(FAST_MATH)
+#define FAST_MATH
+#endif
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    // Worst-case errors over the ranges the firmware uses; run the SIL with -m for a full report
+    float fastSin(float x);                 // 2e-5 absolute
+    float fastCos(float x);                 // 2e-5 absolute
+    float fastAtan2(float y, float x);      // 1.2e-5 radians
+    float fastInvSqrt(float x);             // 5e-6 relative
+    float fastSqrt(float x);                // 5e-6 relative
+    float fastPow(float x, float y);        // 2e-7 relative for x > 0, |y log2(x)| < 126
+
+#ifdef __arm__
+} // extern "C"
+#endif
+
+#ifdef FAST_MATH
+#define SINF(x)     fastSin(x)
+#define COSF(x)     fastCos(x)
+#define ATAN2F(y,x) fastAtan2(y,x)
+#define INVSQRTF(x) fastInvSqrt(x)
+#define SQRTF(x)    fastSqrt(x)
+#define POWF(x,y)   fastPow(x,y)
+#else
+#define SINF(x)     sinf(x)
+#define COSF(x)     cosf(x)
+#define ATAN2F(y,x) atan2f(y,x)
+#define INVSQRTF(x) (1.0f / sqrtf(x))
+#define SQRTF(x)    sqrtf(x)
+#define POWF(x,y)   powf(x,y)
+#endif
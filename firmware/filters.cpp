@@ -40,6 +40,118 @@ int32_t deadbandFilter(int32_t value, int32_t deadband)
     return value;
 }
 
+// biquad low-pass, from the RBJ audio EQ cookbook with Q = 1/sqrt(2)
+void biquadSetLowpass(biquad_t * filter, float cutoffHz, float sampleHz)
+{
+    float omega = 2 * M_PI * cutoffHz / sampleHz;
+    float sn = sinf(omega);
+    float cs = cosf(omega);
+    float alpha = sn / (2 * 0.7071068f);
+    float a0 = 1 + alpha;
+
+    filter->b0 = FILTER_COEFF((1 - cs) / 2 / a0);
+    filter->b1 = FILTER_COEFF((1 - cs) / a0);
+    filter->b2 = filter->b0;
+    filter->a1 = FILTER_COEFF(-2 * cs / a0);
+    filter->a2 = FILTER_COEFF((1 - alpha) / a0);
+}
+
+// biquad notch, also from the cookbook; the -3dB points are at cutoffHz and its
+// geometric mirror about centerHz, which sets Q
+void biquadSetNotch(biquad_t * filter, float centerHz, float cutoffHz, float sampleHz)
+{
+    float q = centerHz * cutoffHz / (centerHz * centerHz - cutoffHz * cutoffHz);
+    float omega = 2 * M_PI * centerHz / sampleHz;
+    float sn = sinf(omega);
+    float cs = cosf(omega);
+    float alpha = sn / (2 * q);
+    float a0 = 1 + alpha;
+
+    filter->b0 = FILTER_COEFF(1 / a0);
+    filter->b1 = FILTER_COEFF(-2 * cs / a0);
+    filter->b2 = filter->b0;
+    filter->a1 = filter->b1;
+    filter->a2 = FILTER_COEFF((1 - alpha) / a0);
+}
+
+void biquadReset(biquad_t * filter)
+{
+    filter->z1 = 0;
+    filter->z2 = 0;
+}
+
+void biquadInitLowpass(biquad_t * filter, float cutoffHz, float sampleHz)
+{
+    biquadSetLowpass(filter, cutoffHz, sampleHz);
+    biquadReset(filter);
+}
+
+void biquadInitNotch(biquad_t * filter, float centerHz, float cutoffHz, float sampleHz)
+{
+    biquadSetNotch(filter, centerHz, cutoffHz, sampleHz);
+    biquadReset(filter);
+}
+
+filterSample_t biquadApply(biquad_t * filter, filterSample_t input)
+{
+    filterSample_t output = FILTER_MUL(filter->b0, input) + filter->z1;
+
+    filter->z1 = FILTER_MUL(filter->b1, input) - FILTER_MUL(filter->a1, output) + filter->z2;
+    filter->z2 = FILTER_MUL(filter->b2, input) - FILTER_MUL(filter->a2, output);
+
+    return output;
+}
+
+// Hamming-windowed sinc
+static float firTap(uint8_t k, uint8_t taps, float fc)
+{
+    float n = k - (taps - 1) / 2.0f;
+    float sinc = (n == 0) ? 2 * fc : sinf(2 * M_PI * fc * n) / (M_PI * n);
+    float window = (taps > 1) ? 0.54f - 0.46f * cosf(2 * M_PI * k / (taps - 1)) : 1;
+
+    return sinc * window;
+}
+
+// FIR low-pass, normalized for unity gain at DC
+void firDesignLowpass(filterCoeff_t * coeffs, uint8_t taps, float cutoffHz, float sampleHz)
+{
+    float fc = cutoffHz / sampleHz;
+    float sum = 0;
+
+    for (uint8_t k=0; k<taps; ++k)
+        sum += firTap(k, taps, fc);
+
+    for (uint8_t k=0; k<taps; ++k)
+        coeffs[k] = FILTER_COEFF(firTap(k, taps, fc) / sum);
+}
+
+void firInit(fir_t * filter, const filterCoeff_t * coeffs, uint8_t taps)
+{
+    filter->coeffs = coeffs;
+    filter->taps = taps;
+    filter->index = 0;
+
+    for (uint8_t k=0; k<FIR_MAX_TAPS; ++k)
+        filter->history[k] = 0;
+}
+
+filterSample_t firApply(fir_t * filter, filterSample_t input)
+{
+    filter->history[filter->index] = input;
+
+    filterSample_t output = 0;
+    uint8_t j = filter->index;
+
+    for (uint8_t k=0; k<filter->taps; ++k) {
+        output += FILTER_MUL(filter->coeffs[k], filter->history[j]);
+        j = (j == 0) ? filter->taps - 1 : j - 1;
+    }
+
+    filter->index = (filter->index + 1) % filter->taps;
+
+    return output;
+}
+
 #ifdef __arm__
 } // extern "C"
 #endif
@@ -15,6 +15,8 @@
    along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
 #ifdef __arm__
 extern "C" {
 #else
@@ -27,6 +29,51 @@ float complementaryFilter(float a, float b, float c);
 // deadband filter
 int32_t deadbandFilter(int32_t value, int32_t deadband);
 
+// Filter samples are Q8 and coefficients Q28 in the fixed-point build
+#ifdef FIXED_POINT
+typedef int32_t filterSample_t;
+typedef int32_t filterCoeff_t;
+#define FILTER_SAMPLE(x)    ((int32_t)(x) << 8)
+#define FILTER_TO_INT(x)    (((x) + 128) >> 8)
+#define FILTER_COEFF(x)     ((int32_t)lrintf((x) * 268435456.0f))
+#define FILTER_MUL(c, x)    ((int32_t)(((int64_t)(c) * (x)) >> 28))
+#else
+typedef float filterSample_t;
+typedef float filterCoeff_t;
+#define FILTER_SAMPLE(x)    ((float)(x))
+#define FILTER_TO_INT(x)    lrintf(x)
+#define FILTER_COEFF(x)     (x)
+#define FILTER_MUL(c, x)    ((c) * (x))
+#endif
+
+// second-order section, direct form II transposed.  The Set functions change the
+// coefficients in flight without disturbing the state; the Init functions also clear it.
+typedef struct biquad_t {
+    filterCoeff_t  b0, b1, b2, a1, a2;
+    filterSample_t z1, z2;
+} biquad_t;
+
+void           biquadInitLowpass(biquad_t * filter, float cutoffHz, float sampleHz);
+void           biquadInitNotch(biquad_t * filter, float centerHz, float cutoffHz, float sampleHz);
+void           biquadSetLowpass(biquad_t * filter, float cutoffHz, float sampleHz);
+void           biquadSetNotch(biquad_t * filter, float centerHz, float cutoffHz, float sampleHz);
+void           biquadReset(biquad_t * filter);
+filterSample_t biquadApply(biquad_t * filter, filterSample_t input);
+
+// FIR filter; coefficients may be shared among several filters
+#define FIR_MAX_TAPS 16
+
+typedef struct fir_t {
+    const filterCoeff_t * coeffs;
+    uint8_t               taps;
+    uint8_t               index;
+    filterSample_t        history[FIR_MAX_TAPS];
+} fir_t;
+
+void           firDesignLowpass(filterCoeff_t * coeffs, uint8_t taps, float cutoffHz, float sampleHz);
+void           firInit(fir_t * filter, const filterCoeff_t * coeffs, uint8_t taps);
+filterSample_t firApply(fir_t * filter, filterSample_t input);
+
 #ifdef __arm__
 } // extern "C"
 #endif
@@ -0,0 +1,111 @@
+/*
+   fixedpoint.cpp : Fixed-point arithmetic for boards without an FPU
+
+   Trig is by table lookup with linear interpolation; the atan2 table's
+   worst-case error is well under 0.01 degree, below its output resolution.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+// atan(k/256) in hundredths of a degree, k = 0..256
+static const int16_t ATAN_TABLE[257] = {
+       0,   22,   45,   67,   90,  112,  134,  157,  179,  201,  224,  246,
+     268,  291,  313,  335,  358,  380,  402,  424,  447,  469,  491,  513,
+     536,  558,  580,  602,  624,  646,  668,  690,  713,  735,  757,  779,
+     800,  822,  844,  866,  888,  910,  932,  953,  975,  997, 1019, 1040,
+    1062, 1084, 1105, 1127, 1148, 1170, 1191, 1213, 1234, 1255, 1277, 1298,
+    1319, 1340, 1361, 1383, 1404, 1425, 1446, 1467, 1488, 1508, 1529, 1550,
+    1571, 1592, 1612, 1633, 1653, 1674, 1695, 1715, 1735, 1756, 1776, 1796,
+    1817, 1837, 1857, 1877, 1897, 1917, 1937, 1957, 1977, 1997, 2016, 2036,
+    2056, 2075, 2095, 2114, 2134, 2153, 2172, 2192, 2211, 2230, 2249, 2268,
+    2287, 2306, 2325, 2344, 2363, 2382, 2400, 2419, 2438, 2456, 2475, 2493,
+    2511, 2530, 2548, 2566, 2584, 2603, 2621, 2639, 2657, 2674, 2692, 2710,
+    2728, 2745, 2763, 2780, 2798, 2815, 2833, 2850, 2867, 2885, 2902, 2919,
+    2936, 2953, 2970, 2987, 3003, 3020, 3037, 3053, 3070, 3086, 3103, 3119,
+    3136, 3152, 3168, 3184, 3201, 3217, 3233, 3249, 3264, 3280, 3296, 3312,
+    3327, 3343, 3359, 3374, 3390, 3405, 3420, 3436, 3451, 3466, 3481, 3496,
+    3511, 3526, 3541, 3556, 3571, 3585, 3600, 3615, 3629, 3644, 3658, 3673,
+    3687, 3701, 3716, 3730, 3744, 3758, 3772, 3786, 3800, 3814, 3828, 3841,
+    3855, 3869, 3882, 3896, 3909, 3923, 3936, 3950, 3963, 3976, 3989, 4003,
+    4016, 4029, 4042, 4055, 4067, 4080, 4093, 4106, 4119, 4131, 4144, 4156,
+    4169, 4181, 4194, 4206, 4218, 4231, 4243, 4255, 4267, 4279, 4291, 4303,
+    4315, 4327, 4339, 4351, 4363, 4374, 4386, 4397, 4409, 4421, 4432, 4443,
+    4455, 4466, 4478, 4489, 4500
+};
+
+int32_t fixAtan2(int32_t y, int32_t x)
+{
+    if (x == 0 && y == 0)
+        return 0;
+
+    uint32_t ax = x < 0 ? -(uint32_t)x : x;
+    uint32_t ay = y < 0 ? -(uint32_t)y : y;
+
+    bool swap = ay > ax;
+    uint32_t num = swap ? ax : ay;
+    uint32_t den = swap ? ay : ax;
+
+    // keep the ratio computation within 32 bits
+    while (den > 0xFFFF) {
+        num >>= 1;
+        den >>= 1;
+    }
+
+    // ratio in [0,1] with 16 fraction bits: top eight index the table, low eight interpolate
+    uint32_t ratio = (num << 16) / den;
+    uint32_t index = ratio >> 8;
+    int32_t  frac  = ratio & 0xFF;
+
+    int32_t angle = ATAN_TABLE[index];
+    if (index < 256)
+        angle += ((ATAN_TABLE[index+1] - angle) * frac + 128) >> 8;
+
+    if (swap)
+        angle = 9000 - angle;
+    if (x < 0)
+        angle = 18000 - angle;
+
+    return y < 0 ? -angle : angle;
+}
+
+uint32_t fixSqrt(uint32_t x)
+{
+    uint32_t result = 0;
+    uint32_t bit = (uint32_t)1 << 30;
+
+    while (bit > x)
+        bit >>= 2;
+
+    while (bit) {
+        if (x >= result + bit) {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+            result >>= 1;
+        bit >>= 2;
+    }
+
+    return result;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
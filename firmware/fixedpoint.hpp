@@ -0,0 +1,41 @@
+/*
+   fixedpoint.hpp : Fixed-point arithmetic for boards without an FPU
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Unit quantities (quaternion components, direction cosines) are Q30
+#define Q30_ONE     ((int32_t)1 << 30)
+#define Q30(x)      ((int32_t)((x) * 1073741824.0))
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    static inline int32_t q30Mul(int32_t a, int32_t b)
+    {
+        return (int32_t)(((int64_t)a * b) >> 30);
+    }
+
+    // angle of (x,y) in hundredths of a degree, [-18000,+18000]
+    int32_t fixAtan2(int32_t y, int32_t x);
+
+    // integer square root, rounded down
+    uint32_t fixSqrt(uint32_t x);
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,97 @@
+/*
+   gaintable.cpp : Rate PID gain schedule over throttle and battery voltage
+
+   Bilinear interpolation in integer arithmetic, cheap enough to run on every
+   rate-loop update on boards without an FPU.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+void GainTable::init(void)
+{
+    // 3S pack, empty to full
+    this->voltageMillivolts[0] = 10500;
+    this->voltageMillivolts[1] = 12600;
+
+    // unscheduled: every entry is the pidvals.hpp gain
+    for (uint8_t v=0; v<GAIN_VOLTAGE_POINTS; ++v)
+        for (uint8_t t=0; t<GAIN_THROTTLE_POINTS; ++t)
+            for (uint8_t k=0; k<3; ++k)
+                this->percent[v][t][k] = 100;
+
+    this->batteryMillivolts = 0;
+}
+
+void GainTable::setBatteryMillivolts(uint16_t millivolts)
+{
+    this->batteryMillivolts = millivolts;
+}
+
+// Segment index and position within it, in 1/256ths, for value among count evenly spaced or listed points
+static void locate(int32_t value, const int32_t * points, uint8_t count, uint8_t & index, int32_t & frac)
+{
+    if (value <= points[0]) {
+        index = 0;
+        frac = 0;
+        return;
+    }
+
+    for (index=0; index<count-1; ++index) 
+        if (value < points[index+1]) {
+            frac = ((value - points[index]) << 8) / (points[index+1] - points[index]);
+            return;
+        }
+
+    index = count - 2;
+    frac = 256;
+}
+
+void GainTable::lookup(int16_t throttle, uint16_t scale[3])
+{
+    int32_t throttlePoints[GAIN_THROTTLE_POINTS];
+    for (uint8_t t=0; t<GAIN_THROTTLE_POINTS; ++t)
+        throttlePoints[t] = CONFIG_PWM_MIN + (int32_t)t * (CONFIG_PWM_MAX - CONFIG_PWM_MIN) / (GAIN_THROTTLE_POINTS - 1);
+
+    int32_t voltagePoints[GAIN_VOLTAGE_POINTS];
+    for (uint8_t v=0; v<GAIN_VOLTAGE_POINTS; ++v)
+        voltagePoints[v] = this->voltageMillivolts[v];
+
+    uint8_t t, v;
+    int32_t tf, vf;
+    locate(throttle, throttlePoints, GAIN_THROTTLE_POINTS, t, tf);
+    if (this->batteryMillivolts)
+        locate(this->batteryMillivolts, voltagePoints, GAIN_VOLTAGE_POINTS, v, vf);
+    else {
+        v = GAIN_VOLTAGE_POINTS - 2;
+        vf = 256;
+    }
+
+    for (uint8_t k=0; k<3; ++k) {
+        int32_t low  = this->percent[v][t][k]   * (256 - tf) + this->percent[v][t+1][k]   * tf;
+        int32_t high = this->percent[v+1][t][k] * (256 - tf) + this->percent[v+1][t+1][k] * tf;
+        int32_t pct256 = (low * (256 - vf) + high * vf) >> 8;   // percent times 256
+
+        scale[k] = (uint16_t)((pct256 * 256 / 100) >> 8);
+    }
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
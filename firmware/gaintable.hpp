@@ -0,0 +1,56 @@
+/*
+   gaintable.hpp : Rate PID gain schedule over throttle and battery voltage
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define GAIN_THROTTLE_POINTS    5       // evenly spaced over [CONFIG_PWM_MIN, CONFIG_PWM_MAX]
+#define GAIN_VOLTAGE_POINTS     2       // at voltageMillivolts[], ascending
+
+enum {
+    GAIN_P = 0,
+    GAIN_I,
+    GAIN_D
+};
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    class GainTable {
+
+        private:
+
+            uint16_t batteryMillivolts;
+
+        public:
+
+            // breakpoints and P/I/D as percent of the pidvals.hpp gains; set over MSP
+            uint16_t voltageMillivolts[GAIN_VOLTAGE_POINTS];
+            uint8_t  percent[GAIN_VOLTAGE_POINTS][GAIN_THROTTLE_POINTS][3];
+
+            void init(void);
+
+            // 0 means not measured, which uses the highest voltage row
+            void setBatteryMillivolts(uint16_t millivolts);
+
+            // P, I, D scale factors at this throttle, in 1/256ths
+            void lookup(int16_t throttle, uint16_t scale[3]);
+    };
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -38,75 +38,243 @@ static MSP        msp;
 //static Baro       baro;
 static Sonars     sonars;
 static Hover      hover;
-static Stabilize  stab;
+static GainTable  gains;
+static Controller stab;
+static Autotune   autotune;
+static Profiler   profiler;
+static Blackbox   blackbox;
+static Scheduler  scheduler;
 
-// support for timed tasks
+// values initialized in setup()
 
-class TimedTask {
+static uint32_t imuLooptimeUsec;
+static uint16_t calibratingGyroCycles;
+static uint16_t calibratingAccCycles;
+static uint16_t calibratingG;
+static bool     haveSmallAngle;
+static bool     armed;
+static bool     accCalibrated;
+static uint16_t calibratingA;
+static uint32_t disarmTime;
+static uint32_t accelCalibrationTime;
 
-    private:
+// LED support
 
-        uint32_t usec;
-        uint32_t period;
+static bool ledGreenOn;
 
-    public:
+static void toggleGreenLED(void)
+{
+    if (ledGreenOn) {
+        Board::ledSetState(0, true);
+        ledGreenOn = false;
+    }
+    else {
+        Board::ledSetState(0, false);
+        ledGreenOn = true;
+    }
+}
 
-        void init(uint32_t _period) {
+static void rcTask(uint32_t currentTime)
+{
+    (void)currentTime;
 
-            this->period = _period;
-            this->usec = 0;
-        }
+    // update RC channels
+    rc.update();
 
-        bool checkAndUpdate(uint32_t currentTime) {
+    // gain schedule follows the pack as it sags
+    gains.setBatteryMillivolts(Board::batteryMillivolts());
 
-            bool result = (int32_t)(currentTime - this->usec) >= 0;
+    //debug("%4d %4d %4d %4d %4d\n", rc.data[0], rc.data[1], rc.data[2], rc.data[3], rc.data[4]);
 
-            if (result)
-                this->update(currentTime);
+    // useful for simulator
+    if (armed)
+        Board::showAuxStatus(rc.auxState());
 
-            return result;
-        }
+    // when landed, reset integral component of PID
+    if (rc.throttleIsDown()) 
+        stab.resetIntegral();
 
-        void update(uint32_t currentTime) {
+    if (rc.changed()) {
 
-            this->usec = currentTime + this->period;
-        }
+        if (armed) {      // actions during armed
 
-        bool check(uint32_t currentTime) {
+            // Disarm on throttle down + yaw
+            if (rc.sticks == THR_LO + YAW_LO + PIT_CE + ROL_CE) {
+                if (armed) {
+                    armed = false;
+                    autotune.stop();
+                    blackbox.stop();
+                    Board::showArmedStatus(armed);
+                    // Reset disarm time so that it works next time we arm the Board::
+                    if (disarmTime != 0)
+                        disarmTime = 0;
+                }
+            }
+        } else {         // actions during not armed
+
+            // gyro calibration
+            if (rc.sticks == THR_LO + YAW_LO + PIT_LO + ROL_CE) 
+                calibratingG = calibratingGyroCycles;
+
+            // Arm via throttle-low / yaw-right; with roll right as well, autotune once airborne
+            if (rc.sticks == THR_LO + YAW_HI + PIT_CE + ROL_CE || rc.sticks == THR_LO + YAW_HI + PIT_CE + ROL_HI)
+                if (calibratingG == 0 && accCalibrated) 
+                    if (!rc.auxState()) // aux switch must be in zero position
+                        if (!armed) {
+                            armed = true;
+                            if (rc.sticks == THR_LO + YAW_HI + PIT_CE + ROL_HI)
+                                autotune.start();
+                            blackbox.start();
+                            Board::showArmedStatus(armed);
+                        }
+
+            // accel calibration
+            if (rc.sticks == THR_HI + YAW_LO + PIT_LO + ROL_CE)
+                calibratingA = calibratingAccCycles;
+
+        } // not armed
+
+    } // rc.changed()
+
+    // Switch to alt-hold when switch moves to position 1 or 2
+    hover.checkSwitch();
+}
 
-            return (int32_t)(currentTime - this->usec) >= 0;
-        }
-};
+static void altitudeTask(uint32_t currentTime)
+{
+    (void)currentTime;
 
+    hover.updateAltitudePid();
+}
 
-// values initialized in setup()
+static void sonarsTask(uint32_t currentTime)
+{
+    (void)currentTime;
 
-static TimedTask imuTask;
-static TimedTask rcTask;
-static TimedTask accelCalibrationTask;
-static TimedTask altitudeEstimationTask;
+    sonars.update();
+}
 
-static uint32_t imuLooptimeUsec;
-static uint16_t calibratingGyroCycles;
-static uint16_t calibratingAccCycles;
-static uint16_t calibratingG;
-static bool     haveSmallAngle;
-static bool     armed;
+static void mspTask(uint32_t currentTime)
+{
+    (void)currentTime;
 
-// LED support
+    // handle serial communications
+    profiler.start(PROFILE_MSP);
+    msp.update(armed);
+    profiler.stop(PROFILE_MSP);
+}
 
-static bool ledGreenOn;
+static void dynNotchTask(uint32_t currentTime)
+{
+    (void)currentTime;
 
-static void toggleGreenLED(void)
+    imu.updateDynamicNotch();
+}
+
+static void blackboxTask(uint32_t currentTime)
 {
-    if (ledGreenOn) {
+    (void)currentTime;
+
+    blackbox.update();
+}
+
+// Stands in for the data-ready interrupt on boards without one: reads the sensor into the IMU's ring
+static void gyroTask(uint32_t currentTime)
+{
+    imu.sample(currentTime);
+}
+
+// Mixer and what follows each motor update, at the rate of the rate loop
+static void updateMotors(uint32_t currentTime)
+{
+    profiler.start(PROFILE_MIXER);
+    mixer.update(armed);
+    profiler.stop(PROFILE_MIXER);
+
+    // retune the gyro's RPM notches from the telemetry that came back with the motor update
+    imu.setMotorRpm(mixer.motorRpm, mixer.motorCount, mixer.rpmValid);
+
+    profiler.start(PROFILE_BLACKBOX);
+    blackbox.log(currentTime);
+    profiler.stop(PROFILE_BLACKBOX);
+}
+
+// Inner rate loop of the cascaded controller, on the newest filtered gyro
+static void rateTask(uint32_t currentTime)
+{
+    imu.updateGyro();
+
+    profiler.start(PROFILE_STABILIZE);
+#if CASCADED_RATE_LOOP
+    stab.updateRate();
+    autotune.update(stab.axisPID, currentTime);
+#endif
+    profiler.stop(PROFILE_STABILIZE);
+
+    updateMotors(currentTime);
+}
+
+static void imuTask(uint32_t currentTime)
+{
+    profiler.imuPeriod(currentTime);
+    profiler.start(PROFILE_LOOP);
+
+    profiler.start(PROFILE_IMU);
+    imu.update(currentTime, armed, calibratingA, calibratingG);
+    profiler.stop(PROFILE_IMU);
+
+    haveSmallAngle = abs(imu.angle[0]) < CONFIG_SMALL_ANGLE && abs(imu.angle[1]) < CONFIG_SMALL_ANGLE;
+
+    // measure loop rate just afer reading the sensors
+    currentTime = Board::getMicros();
+
+    // compute exponential RC commands
+    profiler.start(PROFILE_EXPO);
+    rc.computeExpo();
+    profiler.stop(PROFILE_EXPO);
+
+    // use LEDs to indicate calibration status
+    if (calibratingA > 0 || calibratingG > 0) 
         Board::ledSetState(0, true);
-        ledGreenOn = false;
-    }
     else {
-        Board::ledSetState(0, false);
-        ledGreenOn = true;
+        if (accCalibrated)
+            Board::ledSetState(0, false);
+        if (armed)
+            Board::ledSetState(1, true);
+        else
+            Board::ledSetState(1, false);
+    }
+
+    // periodically update accelerometer calibration status
+    if ((int32_t)(currentTime - accelCalibrationTime) >= 0) {
+        if (!haveSmallAngle) {
+            accCalibrated = false; 
+            toggleGreenLED();
+            accelCalibrationTime = currentTime + CONFIG_CALIBRATE_ACCTIME_MSEC * 1000;
+        } else {
+            accCalibrated = true;
+        }
     }
+
+    // perform hover tasks (alt-hold etc.)
+    profiler.start(PROFILE_HOVER);
+    hover.perform();
+    profiler.stop(PROFILE_HOVER);
+
+#if CASCADED_RATE_LOOP
+    // outer angle loop only; rateTask runs the rate loop and mixer
+    stab.updateAngle();
+#else
+    // update stability PID controller 
+    profiler.start(PROFILE_STABILIZE);
+    stab.update();
+    autotune.update(stab.axisPID, currentTime);
+    profiler.stop(PROFILE_STABILIZE);
+
+    updateMotors(currentTime);
+#endif
+
+    profiler.stop(PROFILE_LOOP);
 }
 
 void setup(void)
@@ -135,23 +303,22 @@ void setup(void)
     calibratingGyroCycles = (uint16_t)(1000. * calibratingGyroMsec / imuLooptimeUsec);
     calibratingAccCycles  = (uint16_t)(1000. * CONFIG_CALIBRATING_ACC_MSEC  / imuLooptimeUsec);
 
-    // initializing timing tasks
-    imuTask.init(imuLooptimeUsec);
-    rcTask.init(CONFIG_RC_LOOPTIME_MSEC * 1000);
-    accelCalibrationTask.init(CONFIG_CALIBRATE_ACCTIME_MSEC * 1000);
-    altitudeEstimationTask.init(CONFIG_ALTITUDE_UPDATE_MSEC * 1000);
-
     // attempt to initialize barometer, sonars
     //baro.init();
     sonars.init();
 
     // initialize our external objects with objects they need
     rc.init();
-    stab.init(&rc, &imu);
-    imu.init(calibratingGyroCycles, calibratingAccCycles);
+    imu.init(calibratingGyroCycles, calibratingAccCycles, imuLooptimeUsec);
+
+    gains.init();
+    stab.init(&rc, &imu, &gains, imuLooptimeUsec);
+    autotune.init(&rc, &imu, imuLooptimeUsec);
     mixer.init(&rc, &stab); 
-    msp.init(&imu, &hover, &mixer, &rc, &sonars);
+    msp.init(&imu, &hover, &mixer, &rc, &sonars, &profiler, &scheduler, &gains, &autotune, &blackbox);
     hover.init(&imu, &sonars, &rc);
+    profiler.init(imuLooptimeUsec);
+    blackbox.init(&imu, &rc, &stab, &mixer, CASCADED_RATE_LOOP ? imuLooptimeUsec / CONFIG_RATE_LOOP_MULTIPLE : imuLooptimeUsec);
 
     // always do gyro calibration at startup
     calibratingG = calibratingGyroCycles;
@@ -161,156 +328,35 @@ void setup(void)
 
     // ensure not armed
     armed = false;
+
+    // declare tasks, in priority order
+    scheduler.init();
+    scheduler.add(TASK_GYRO,     gyroTask,     1000000 / CONFIG_GYRO_SAMPLE_HZ,             CONFIG_GYRO_BUDGET_USEC);
+    scheduler.add(TASK_RATE,     rateTask,     imuLooptimeUsec / CONFIG_RATE_LOOP_MULTIPLE, CONFIG_RATE_BUDGET_USEC);
+    scheduler.add(TASK_IMU,      imuTask,      imuLooptimeUsec,                        CONFIG_IMU_BUDGET_USEC);
+    scheduler.add(TASK_RC,       rcTask,       CONFIG_RC_LOOPTIME_MSEC * 1000,         CONFIG_RC_BUDGET_USEC);
+    scheduler.add(TASK_ALTITUDE, altitudeTask, CONFIG_ALTITUDE_UPDATE_MSEC * 1000,     CONFIG_ALTITUDE_BUDGET_USEC);
+    scheduler.add(TASK_SONARS,   sonarsTask,   CONFIG_SONARS_UPDATE_MSEC * 1000,       CONFIG_SONARS_BUDGET_USEC);
+    scheduler.add(TASK_MSP,      mspTask,      CONFIG_MSP_UPDATE_MSEC * 1000,          CONFIG_MSP_BUDGET_USEC);
+    scheduler.add(TASK_DYN_NOTCH, dynNotchTask, CONFIG_DYN_NOTCH_UPDATE_MSEC * 1000,    CONFIG_DYN_NOTCH_BUDGET_USEC);
+    scheduler.add(TASK_BLACKBOX, blackboxTask, CONFIG_BLACKBOX_UPDATE_MSEC * 1000,     CONFIG_BLACKBOX_BUDGET_USEC);
+    scheduler.enable(TASK_GYRO, imu.sampleTask);
+    scheduler.enable(TASK_ALTITUDE, sonars.available());
+    scheduler.enable(TASK_SONARS, sonars.available());
+    scheduler.enable(TASK_RATE, CASCADED_RATE_LOOP);
+    scheduler.enable(TASK_DYN_NOTCH, CONFIG_GYRO_DYN_NOTCH);
+    scheduler.enable(TASK_BLACKBOX, blackbox.available);
+    accelCalibrationTime = Board::getMicros();
     
 } // setup
 
 void loop(void)
 {
-    static bool     accCalibrated;
-    static uint16_t calibratingA;
-    static uint32_t currentTime;
-    static uint32_t disarmTime;
-
-    bool rcSerialReady = Board::rcSerialReady();
-
-    if (rcTask.checkAndUpdate(currentTime) || rcSerialReady) {
-
-        // update RC channels
-        rc.update();
-
-        rcSerialReady = false;
-
-        //debug("%4d %4d %4d %4d %4d\n", rc.data[0], rc.data[1], rc.data[2], rc.data[3], rc.data[4]);
-
-        // useful for simulator
-        if (armed)
-            Board::showAuxStatus(rc.auxState());
-
-        // when landed, reset integral component of PID
-        if (rc.throttleIsDown()) 
-            stab.resetIntegral();
-
-        if (rc.changed()) {
-
-            if (armed) {      // actions during armed
-
-                // Disarm on throttle down + yaw
-                if (rc.sticks == THR_LO + YAW_LO + PIT_CE + ROL_CE) {
-                    if (armed) {
-                        armed = false;
-                        Board::showArmedStatus(armed);
-                        // Reset disarm time so that it works next time we arm the Board::
-                        if (disarmTime != 0)
-                            disarmTime = 0;
-                    }
-                }
-            } else {         // actions during not armed
-
-                // gyro calibration
-                if (rc.sticks == THR_LO + YAW_LO + PIT_LO + ROL_CE) 
-                    calibratingG = calibratingGyroCycles;
-
-                // Arm via throttle-low / yaw-right
-                if (rc.sticks == THR_LO + YAW_HI + PIT_CE + ROL_CE)
-                    if (calibratingG == 0 && accCalibrated) 
-                        if (!rc.auxState()) // aux switch must be in zero position
-                            if (!armed) {
-                                armed = true;
-                                Board::showArmedStatus(armed);
-                            }
-
-                // accel calibration
-                if (rc.sticks == THR_HI + YAW_LO + PIT_LO + ROL_CE)
-                    calibratingA = calibratingAccCycles;
-
-            } // not armed
-
-        } // rc.changed()
-
-        // Switch to alt-hold when switch moves to position 1 or 2
-        hover.checkSwitch();
-
-    } else {                    // not in rc loop
-
-        static int taskOrder;   // never call all functions in the same loop, to avoid high delay spikes
-
-        switch (taskOrder) {
-            case 0:
-                //if (baro.available())
-                //    baro.update();
-                taskOrder++;
-                break;
-            case 1:
-                if (sonars.available() && altitudeEstimationTask.checkAndUpdate(currentTime)) {
-                    hover.updateAltitudePid();
-                }
-                taskOrder++;
-                break;
-            case 2:
-                if (sonars.available())
-                    sonars.update();
-                taskOrder++;
-                break;
-            case 3:
-                taskOrder++;
-                break;
-            case 4:
-                taskOrder = 0;
-                break;
-        }
-    }
-
-    currentTime = Board::getMicros();
-
-    if (imuTask.checkAndUpdate(currentTime)) {
-
-
-        imu.update(currentTime, armed, calibratingA, calibratingG);
-
-        haveSmallAngle = abs(imu.angle[0]) < CONFIG_SMALL_ANGLE && abs(imu.angle[1]) < CONFIG_SMALL_ANGLE;
-
-        // measure loop rate just afer reading the sensors
-        currentTime = Board::getMicros();
-
-        // compute exponential RC commands
-        rc.computeExpo();
-
-        // use LEDs to indicate calibration status
-        if (calibratingA > 0 || calibratingG > 0) 
-            Board::ledSetState(0, true);
-        else {
-            if (accCalibrated)
-                Board::ledSetState(0, false);
-            if (armed)
-                Board::ledSetState(1, true);
-            else
-                Board::ledSetState(1, false);
-        }
-
-        // periodically update accelerometer calibration status
-        if (accelCalibrationTask.check(currentTime)) {
-            if (!haveSmallAngle) {
-                accCalibrated = false; 
-                toggleGreenLED();
-                accelCalibrationTask.update(currentTime);
-            } else {
-                accCalibrated = true;
-            }
-        }
-
-        // handle serial communications
-        msp.update(armed);
-
-        // perform hover tasks (alt-hold etc.)
-        hover.perform();
-
-        // update stability PID controller 
-        stab.update();
-
-        // update mixer
-        mixer.update(armed);
+    // a serial receiver frame is handled as soon as it arrives
+    if (Board::rcSerialReady())
+        scheduler.trigger(TASK_RC);
 
-    } // IMU update
+    scheduler.run();
 
 } // loop()
 
@@ -21,6 +21,8 @@
 #include <stdio.h>
 
 #include "crossplatform.h"
+#include "fixedpoint.hpp"
+#include "fastmath.hpp"
 
 #ifndef M_PI
 #endif
@@ -28,15 +30,25 @@
 void debug(const char * format, ...);
 
 #include "board.hpp"
+#include "dshot.hpp"
+#include "filters.hpp"
+#include "imuring.hpp"
+#include "dynnotch.hpp"
 #include "imu.hpp"
 #include "rc.hpp"
+#include "gaintable.hpp"
 #include "stabilize.hpp"
+#include "pidcontroller.hpp"
+#include "autotune.hpp"
 #include "mixer.hpp"
 #include "baro.hpp"
 #include "sonars.hpp"
 #include "msp.hpp"
 #include "hover.hpp"
-#include "filters.hpp"
+#include "profiler.hpp"
+#include "blackboxencoder.hpp"
+#include "blackbox.hpp"
+#include "scheduler.hpp"
 
 #ifndef abs
 #define abs(x)    ((x) > 0 ? (x) : -(x))
@@ -57,3 +69,18 @@ void debug(const char * format, ...);
 #define CONFIG_CALIBRATE_ACCTIME_MSEC               500
 #define CONFIG_SMALL_ANGLE                          250  // tenths of a degree
 #define CONFIG_ALTITUDE_UPDATE_MSEC                 25   // based on accelerometer low-pass filter
+#define CONFIG_SONARS_UPDATE_MSEC                   10   // one sonar per update
+#define CONFIG_MSP_UPDATE_MSEC                      5
+#define CONFIG_DYN_NOTCH_UPDATE_MSEC                1    // one FFT slice per update
+#define CONFIG_BLACKBOX_UPDATE_MSEC                 1
+
+// Worst-case execution time allowed to each task, for scheduling
+#define CONFIG_GYRO_BUDGET_USEC                     400  // two blocking I2C reads at 400kHz
+#define CONFIG_RATE_BUDGET_USEC                     150
+#define CONFIG_IMU_BUDGET_USEC                      1000
+#define CONFIG_RC_BUDGET_USEC                       200
+#define CONFIG_ALTITUDE_BUDGET_USEC                 100
+#define CONFIG_SONARS_BUDGET_USEC                   100
+#define CONFIG_MSP_BUDGET_USEC                      500
+#define CONFIG_DYN_NOTCH_BUDGET_USEC                100
+#define CONFIG_BLACKBOX_BUDGET_USEC                 100
@@ -26,6 +26,8 @@ extern "C" {
 #include "hackflight.hpp"
 #include "filters.hpp"
 
+#include <string.h>
+
 #define INV_GYR_CMPF_FACTOR   (1.0f / ((float)CONFIG_GYRO_CMPF_FACTOR + 1.0f))
 #define INV_GYR_CMPFM_FACTOR  (1.0f / ((float)CONFIG_GYRO_CMPFM_FACTOR + 1.0f))
 
@@ -67,14 +69,16 @@ static float devVariance(stdev_t *dev)
 
 static float devStandardDeviation(stdev_t *dev)
 {
-    return sqrtf(devVariance(dev));
+    return SQRTF(devVariance(dev));
 }
 
 
+#ifndef FIXED_POINT
+
 // Normalize a vector
 static void normalizeV(float src[3], float dest[3])
 {
-    float length = sqrtf(src[X] * src[X] + src[Y] * src[Y] + src[Z] * src[Z]);
+    float length = SQRTF(src[X] * src[X] + src[Y] * src[Y] + src[Z] * src[Z]);
 
     if (length != 0) {
         dest[X] = src[X] / length;
@@ -93,12 +97,12 @@ static void rotateV(float v[3], float *delta)
     float cosx, sinx, cosy, siny, cosz, sinz;
     float coszcosx, sinzcosx, coszsinx, sinzsinx;
 
-    cosx = cosf(delta[AXIS_ROLL]);
-    sinx = sinf(delta[AXIS_ROLL]);
-    cosy = cosf(delta[AXIS_PITCH]);
-    siny = sinf(delta[AXIS_PITCH]);
-    cosz = cosf(delta[AXIS_YAW]);
-    sinz = sinf(delta[AXIS_YAW]);
+    cosx = COSF(delta[AXIS_ROLL]);
+    sinx = SINF(delta[AXIS_ROLL]);
+    cosy = COSF(delta[AXIS_PITCH]);
+    siny = SINF(delta[AXIS_PITCH]);
+    cosz = COSF(delta[AXIS_YAW]);
+    sinz = SINF(delta[AXIS_YAW]);
 
     coszcosx = cosz * cosx;
     sinzcosx = sinz * cosx;
@@ -120,7 +124,9 @@ static void rotateV(float v[3], float *delta)
     v[Z] = v_tmp[X] * mat[0][2] + v_tmp[Y] * mat[1][2] + v_tmp[Z] * mat[2][2];
 }
 
-void IMU::init(uint16_t _calibratingGyroCycles, uint16_t _calibratingAccCycles) 
+#endif
+
+void IMU::init(uint16_t _calibratingGyroCycles, uint16_t _calibratingAccCycles, uint32_t looptimeUsec) 
 {
     Board::imuInit(this->acc1G, this->gyroScale);
 
@@ -135,36 +141,430 @@ void IMU::init(uint16_t _calibratingGyroCycles, uint16_t _calibratingAccCycles)
 
     this->calibratingGyroCycles = _calibratingGyroCycles;
     this->calibratingAccCycles = _calibratingAccCycles;
+
+    // the gyro filters run on each ring sample, or once per loop on a polled gyro
+    this->gyroSampleHz = CONFIG_IMU_RING ? CONFIG_GYRO_SAMPLE_HZ : 1e6f / looptimeUsec;
+
+    this->ring.init();
+    this->previousSampleTime = 0;
+    this->ringCount = 0;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        this->gyroRaw[axis] = 0;
+        this->gyroZero[axis] = 0;
+        this->ringAccelSum[axis] = 0;
+        this->ringGyroIntegral[axis] = 0;
+    }
+    firDesignLowpass(this->gyroFirCoeffs, CONFIG_GYRO_FIR_TAPS, CONFIG_GYRO_LPF_HZ, this->gyroSampleHz);
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        biquadInitLowpass(&this->gyroBiquad[axis], CONFIG_GYRO_LPF_HZ, this->gyroSampleHz);
+        firInit(&this->gyroFir[axis], this->gyroFirCoeffs, CONFIG_GYRO_FIR_TAPS);
+        biquadReset(&this->gyroNotch[axis]);
+    }
+    this->setGyroNotch(CONFIG_GYRO_NOTCH_HZ, CONFIG_GYRO_NOTCH_CUTOFF_HZ);
+    this->dynNotch.init(this->gyroSampleHz);
+#if CONFIG_RPM_NOTCH
+    // cutoff fraction of the center giving the configured Q in biquadSetNotch()
+    this->rpmNotchCutoffRatio = (sqrtf(1 + 4 * CONFIG_RPM_NOTCH_Q * CONFIG_RPM_NOTCH_Q) - 1) / (2 * CONFIG_RPM_NOTCH_Q);
+    this->rpmNotchMotors = 0;
+    memset(this->rpmNotchActive, 0, sizeof(this->rpmNotchActive));
+#endif
+
+#ifdef FIXED_POINT
+    this->quat[0] = Q30_ONE;
+    // about 2^22 at 2000 deg/sec full scale, so rounding leaves it good to a part in ten million
+    this->gyroScaleQ52 = (int64_t)(this->gyroScale * 0.000001 * 4503599627370496.0 + 0.5);
+    this->fcAccUsec = (int32_t)(this->fcAcc * 1000000);
+#else
+    this->quat[0] = 1;
+#endif
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        this->quat[axis+1] = 0;
+        this->integralError[axis] = 0;
+    }
+
+    this->sampleTask = CONFIG_IMU_RING && !Board::imuStartInterrupt(&this->ring);
+}
+
+void IMU::sample(uint32_t currentTime)
+{
+    int16_t accADC[3], gyroADC[3];
+
+    Board::imuRead(accADC, gyroADC);
+
+    this->ring.push(currentTime, accADC, gyroADC);
+}
+
+#ifdef FIXED_POINT
+
+// Mahony gains and microseconds, scaled by 2^36 for the Q30 update
+static const int64_t MAHONY_KP_Q36 = (int64_t)(CONFIG_MAHONY_KP * 0.000001 * 68719476736.0);
+static const int64_t MAHONY_KI_Q36 = (int64_t)(CONFIG_MAHONY_KI * 0.000001 * 68719476736.0);
+static const int64_t USEC_Q36      = (int64_t)(0.000001 * 68719476736.0);
+
+// Fixed-point Mahony filter: as below, in Q30 with table-based atan2
+void IMU::mahonyUpdate(int32_t deltaGyroAngle[3], int16_t accelSmooth[3], bool useAccel, uint32_t deltaT_usec,
+        int32_t angleCentidegrees[3], int32_t accel_ned[3])
+{
+    int32_t * q = this->quat;
+
+    // estimated direction of gravity in body frame
+    int32_t vx = 2 * (q30Mul(q[1], q[3]) - q30Mul(q[0], q[2]));
+    int32_t vy = 2 * (q30Mul(q[0], q[1]) + q30Mul(q[2], q[3]));
+    int32_t vz = q30Mul(q[0], q[0]) - q30Mul(q[1], q[1]) - q30Mul(q[2], q[2]) + q30Mul(q[3], q[3]);
+
+    int32_t delta[3] = {deltaGyroAngle[X], deltaGyroAngle[Y], deltaGyroAngle[Z]};
+
+    int64_t dt = deltaT_usec < 65535 ? deltaT_usec : 65535;
+
+    int32_t ax = accelSmooth[X];
+    int32_t ay = accelSmooth[Y];
+    int32_t az = accelSmooth[Z];
+
+    if (useAccel) {
+
+        int32_t norm = fixSqrt((uint32_t)(ax*ax) + (uint32_t)(ay*ay) + (uint32_t)(az*az));
+
+        if (norm > 0) {
+
+            // unit accel in Q15
+            int32_t nx = (ax << 15) / norm;
+            int32_t ny = (ay << 15) / norm;
+            int32_t nz = (az << 15) / norm;
+
+            // error is cross product of measured and estimated gravity
+            int32_t e[3] = {
+                (int32_t)(((int64_t)ny*vz - (int64_t)nz*vy) >> 15),
+                (int32_t)(((int64_t)nz*vx - (int64_t)nx*vz) >> 15),
+                (int32_t)(((int64_t)nx*vy - (int64_t)ny*vx) >> 15)
+            };
+
+            for (uint8_t axis = 0; axis < 3; axis++) {
+                this->integralError[axis] += (int32_t)((e[axis] * dt * MAHONY_KI_Q36) >> 36);
+                delta[axis] += (int32_t)((e[axis] * dt * MAHONY_KP_Q36) >> 36) + 
+                    (int32_t)((this->integralError[axis] * dt * USEC_Q36) >> 36);
+            }
+        }
+    }
+
+    // q += q * (0, delta/2)
+    int32_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] += (-q30Mul(q1, delta[X]) - q30Mul(q2, delta[Y]) - q30Mul(q3, delta[Z])) / 2;
+    q[1] += ( q30Mul(q0, delta[X]) + q30Mul(q2, delta[Z]) - q30Mul(q3, delta[Y])) / 2;
+    q[2] += ( q30Mul(q0, delta[Y]) - q30Mul(q1, delta[Z]) + q30Mul(q3, delta[X])) / 2;
+    q[3] += ( q30Mul(q0, delta[Z]) + q30Mul(q1, delta[Y]) - q30Mul(q2, delta[X])) / 2;
+
+    // one Newton step toward unit length, q *= (3 - |q|^2) / 2, needs no square root
+    int32_t norm2 = q30Mul(q[0], q[0]) + q30Mul(q[1], q[1]) + q30Mul(q[2], q[2]) + q30Mul(q[3], q[3]);
+    int32_t factor = Q30_ONE + (Q30_ONE - norm2) / 2;
+    for (uint8_t k=0; k<4; ++k)
+        q[k] = q30Mul(q[k], factor);
+
+    // gravity direction is the last row of the body-to-earth rotation
+    vx = 2 * (q30Mul(q[1], q[3]) - q30Mul(q[0], q[2]));
+    vy = 2 * (q30Mul(q[0], q[1]) + q30Mul(q[2], q[3]));
+    vz = q30Mul(q[0], q[0]) - q30Mul(q[1], q[1]) - q30Mul(q[2], q[2]) + q30Mul(q[3], q[3]);
+
+    // sqrt(vy^2 + vz^2) = sqrt(1 - vx^2), in Q15
+    int32_t vx2 = q30Mul(vx, vx);
+    int32_t horizontal = fixSqrt(vx2 < Q30_ONE ? Q30_ONE - vx2 : 0);
+
+    // heading arguments are halved to stay within 32 bits
+    angleCentidegrees[AXIS_ROLL]  = fixAtan2(vy, vz);
+    angleCentidegrees[AXIS_PITCH] = fixAtan2(-vx >> 15, horizontal);
+    angleCentidegrees[AXIS_YAW]   = -fixAtan2(q30Mul(q[0], q[3]) + q30Mul(q[1], q[2]), 
+                                              Q30_ONE / 2 - q30Mul(q[2], q[2]) - q30Mul(q[3], q[3]));
+
+    // rotate accel into earth frame
+    int32_t r00 = q30Mul(q[0], q[0]) + q30Mul(q[1], q[1]) - q30Mul(q[2], q[2]) - q30Mul(q[3], q[3]);
+    int32_t r01 = 2 * (q30Mul(q[1], q[2]) - q30Mul(q[0], q[3]));
+    int32_t r02 = 2 * (q30Mul(q[1], q[3]) + q30Mul(q[0], q[2]));
+    int32_t r10 = 2 * (q30Mul(q[1], q[2]) + q30Mul(q[0], q[3]));
+    int32_t r11 = q30Mul(q[0], q[0]) - q30Mul(q[1], q[1]) + q30Mul(q[2], q[2]) - q30Mul(q[3], q[3]);
+    int32_t r12 = 2 * (q30Mul(q[2], q[3]) - q30Mul(q[0], q[1]));
+    accel_ned[X] = (int32_t)(((int64_t)r00*ax + (int64_t)r01*ay + (int64_t)r02*az) >> 30);
+    accel_ned[Y] = (int32_t)(((int64_t)r10*ax + (int64_t)r11*ay + (int64_t)r12*az) >> 30);
+    accel_ned[Z] = (int32_t)(((int64_t)vx*ax  + (int64_t)vy*ay  + (int64_t)vz*az)  >> 30);
+}
+
+#else
+
+// Mahony filter: first-order quaternion update from gyro angle increments, nudged toward
+// the accelerometer's gravity direction.  Outputs angles in the same sense as rotateV() version.
+void IMU::mahonyUpdate(float deltaGyroAngle[3], int16_t accelSmooth[3], bool useAccel, float deltaT_sec,
+        float anglerad[3], float accel_ned[3])
+{
+    float * q = this->quat;
+
+    // estimated direction of gravity in body frame
+    float vx = 2 * (q[1]*q[3] - q[0]*q[2]);
+    float vy = 2 * (q[0]*q[1] + q[2]*q[3]);
+    float vz = q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3];
+
+    float delta[3] = {deltaGyroAngle[X], deltaGyroAngle[Y], deltaGyroAngle[Z]};
+
+    if (useAccel) {
+
+        float ax = accelSmooth[X];
+        float ay = accelSmooth[Y];
+        float az = accelSmooth[Z];
+        float norm2 = ax*ax + ay*ay + az*az;
+
+        if (norm2 > 0) {
+
+            float recipNorm = INVSQRTF(norm2);
+
+            // error is cross product of measured and estimated gravity
+            float e[3] = {(ay*vz - az*vy) * recipNorm, (az*vx - ax*vz) * recipNorm, (ax*vy - ay*vx) * recipNorm};
+
+            for (uint8_t axis = 0; axis < 3; axis++) {
+                this->integralError[axis] += CONFIG_MAHONY_KI * e[axis] * deltaT_sec;
+                delta[axis] += (CONFIG_MAHONY_KP * e[axis]) * deltaT_sec + this->integralError[axis] * deltaT_sec;
+            }
+        }
+    }
+
+    // q += q * (0, delta/2)
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] += 0.5f * (-q1*delta[X] - q2*delta[Y] - q3*delta[Z]);
+    q[1] += 0.5f * ( q0*delta[X] + q2*delta[Z] - q3*delta[Y]);
+    q[2] += 0.5f * ( q0*delta[Y] - q1*delta[Z] + q3*delta[X]);
+    q[3] += 0.5f * ( q0*delta[Z] + q1*delta[Y] - q2*delta[X]);
+
+    float recipNorm = INVSQRTF(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    for (uint8_t k=0; k<4; ++k)
+        q[k] *= recipNorm;
+
+    // gravity direction is the last row of the body-to-earth rotation
+    vx = 2 * (q[1]*q[3] - q[0]*q[2]);
+    vy = 2 * (q[0]*q[1] + q[2]*q[3]);
+    vz = q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3];
+
+    anglerad[AXIS_ROLL]  = ATAN2F(vy, vz);
+    anglerad[AXIS_PITCH] = ATAN2F(-vx, SQRTF(vy*vy + vz*vz));
+    anglerad[AXIS_YAW]   = -ATAN2F(2 * (q[0]*q[3] + q[1]*q[2]), 1 - 2 * (q[2]*q[2] + q[3]*q[3]));
+
+    // rotate accel into earth frame
+    float ax = accelSmooth[X];
+    float ay = accelSmooth[Y];
+    float az = accelSmooth[Z];
+    accel_ned[X] = (1 - 2*(q[2]*q[2] + q[3]*q[3]))*ax + 2*(q[1]*q[2] - q[0]*q[3])*ay + 2*(q[1]*q[3] + q[0]*q[2])*az;
+    accel_ned[Y] = 2*(q[1]*q[2] + q[0]*q[3])*ax + (1 - 2*(q[1]*q[1] + q[3]*q[3]))*ay + 2*(q[2]*q[3] - q[0]*q[1])*az;
+    accel_ned[Z] = vx*ax + vy*ay + vz*az;
+}
+
+#endif // FIXED_POINT
+
+// Retunes the static gyro notch in place, so that its state carries over and the gyro doesn't step
+void IMU::setGyroNotch(float centerHz, float cutoffHz)
+{
+    this->gyroNotchEnabled = centerHz > 0 && cutoffHz > 0 && cutoffHz < centerHz && centerHz < this->gyroSampleHz / 2;
+
+    if (this->gyroNotchEnabled)
+        for (uint8_t axis = 0; axis < 3; axis++)
+            biquadSetNotch(&this->gyroNotch[axis], centerHz, cutoffHz, this->gyroSampleHz);
+}
+
+float IMU::gyroDegreesPerSecondPerCount(void)
+{
+    return this->gyroScale * (float)(180 / M_PI);
+}
+
+float IMU::gyroDegreesPerSecond(uint8_t axis)
+{
+    return this->gyroADC[axis] * this->gyroDegreesPerSecondPerCount();
+}
+
+void IMU::setMotorRpm(const uint16_t rpm[], uint8_t motorCount, bool valid)
+{
+#if CONFIG_RPM_NOTCH
+    // without every motor's RPM a notch could sit on a stale frequency
+    if (!valid) {
+        this->rpmNotchMotors = 0;
+        memset(this->rpmNotchActive, 0, sizeof(this->rpmNotchActive));
+        return;
+    }
+
+    this->rpmNotchMotors = min(motorCount, CONFIG_RPM_NOTCH_MOTORS);
+
+    for (uint8_t m = 0; m < this->rpmNotchMotors; m++) {
+        for (uint8_t h = 0; h < CONFIG_RPM_NOTCH_HARMONICS; h++) {
+
+            biquad_t * notch = this->rpmNotch[m][h];
+            float centerHz = rpm[m] / 60.f * (h + 1);
+            // the polled gyro samples at the loop rate, so fewer harmonics fit below Nyquist
+            bool active = centerHz >= CONFIG_RPM_NOTCH_MIN_HZ && centerHz < 0.48f * this->gyroSampleHz;
+
+            // an idle notch's state belongs to some earlier frequency
+            if (active && !this->rpmNotchActive[m][h])
+                for (uint8_t axis = 0; axis < 3; axis++)
+                    biquadReset(&notch[axis]);
+
+            this->rpmNotchActive[m][h] = active;
+
+            if (!active)
+                continue;
+
+            // the axes share a design, so compute it once
+            biquadSetNotch(&notch[0], centerHz, centerHz * this->rpmNotchCutoffRatio, this->gyroSampleHz);
+            for (uint8_t axis = 1; axis < 3; axis++) {
+                notch[axis].b0 = notch[0].b0;
+                notch[axis].b1 = notch[0].b1;
+                notch[axis].b2 = notch[0].b2;
+                notch[axis].a1 = notch[0].a1;
+                notch[axis].a2 = notch[0].a2;
+            }
+        }
+    }
+#else
+    (void)rpm;
+    (void)motorCount;
+    (void)valid;
+#endif
+}
+
+void IMU::updateDynamicNotch(void)
+{
+    // fed from filterGyro() at gyroSampleHz, whether the gyro comes from the ring or is polled
+    if (CONFIG_GYRO_DYN_NOTCH)
+        this->dynNotch.step();
+}
+
+void IMU::updateGyro(void)
+{
+    // a polled gyro is read only with the attitude
+    if (CONFIG_IMU_RING)
+        this->drainRing();
+}
+
+// Notches, then the decimator's anti-alias low-pass (none for plain averaging), on one gyro sample
+filterSample_t IMU::filterGyro(uint8_t axis, int16_t gyroADC)
+{
+    filterSample_t gyro = FILTER_SAMPLE(gyroADC);
+
+    if (this->gyroNotchEnabled)
+        gyro = biquadApply(&this->gyroNotch[axis], gyro);
+#if CONFIG_RPM_NOTCH
+    for (uint8_t m = 0; m < this->rpmNotchMotors; m++)
+        for (uint8_t h = 0; h < CONFIG_RPM_NOTCH_HARMONICS; h++)
+            if (this->rpmNotchActive[m][h])
+                gyro = biquadApply(&this->rpmNotch[m][h][axis], gyro);
+#endif
+    if (CONFIG_GYRO_DYN_NOTCH)
+        gyro = this->dynNotch.apply(axis, gyroADC, gyro);
+
+    switch (CONFIG_GYRO_DECIMATOR) {
+        case GYRO_DECIMATOR_FIR:
+            return firApply(&this->gyroFir[axis], gyro);
+        case GYRO_DECIMATOR_BIQUAD:
+            return biquadApply(&this->gyroBiquad[axis], gyro);
+        default:
+            return gyro;
+    }
+}
+
+// Filter the new ring samples, accumulating them for the next attitude update
+void IMU::drainRing(void)
+{
+    imuSample_t sample;
+    int32_t gyroSum[3] = {0, 0, 0};
+    filterSample_t gyroFiltered[3] = {0, 0, 0};
+    uint8_t count = 0;
+
+    while (this->ring.pop(sample)) {
+
+        if (this->ringCount == 0)
+            this->ringFirstTime = this->previousSampleTime;
+
+        // first sample ever has no predecessor to measure from
+        uint32_t dt = this->previousSampleTime ? sample.usec - this->previousSampleTime : 0;
+
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            this->ringAccelSum[axis] += sample.accADC[axis];
+            this->ringGyroIntegral[axis] += (int64_t)sample.gyroADC[axis] * dt;
+            filterSample_t gyro = this->filterGyro(axis, sample.gyroADC[axis]);
+            if (CONFIG_GYRO_DECIMATOR == GYRO_DECIMATOR_AVERAGE)
+                gyroSum[axis] += FILTER_TO_INT(gyro);
+            else
+                gyroFiltered[axis] = gyro;
+        }
+
+        this->previousSampleTime = sample.usec;
+        this->ringCount++;
+        count++;
+    }
+
+    if (count == 0)
+        return;
+
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        this->gyroRaw[axis] = (CONFIG_GYRO_DECIMATOR == GYRO_DECIMATOR_AVERAGE) ? 
+            gyroSum[axis] / count : (int16_t)FILTER_TO_INT(gyroFiltered[axis]);
+        this->gyroADC[axis] = this->gyroRaw[axis] - this->gyroZero[axis];
+    }
+}
+
+// Averages the queued accel samples, and integrates gyro over their true spacing.  Gyro for the
+// PID is the anti-alias filter's latest output, or the plain average of the samples.
+bool IMU::readRing(int16_t accelADC[3], int64_t gyroIntegral[3], uint32_t & deltaT_usec)
+{
+    this->drainRing();
+
+    if (this->ringCount == 0)
+        return false;
+
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        accelADC[axis] = this->ringAccelSum[axis] / this->ringCount;
+        gyroIntegral[axis] = this->ringGyroIntegral[axis];
+        this->ringAccelSum[axis] = 0;
+        this->ringGyroIntegral[axis] = 0;
+    }
+
+    deltaT_usec = this->ringFirstTime ? this->previousSampleTime - this->ringFirstTime : 0;
+
+    this->ringCount = 0;
+
+    return true;
 }
 
 void IMU::update(uint32_t currentTime, bool armed, uint16_t & calibratingA, uint16_t & calibratingG)
 {
+#ifdef FIXED_POINT
+    static int32_t  accelLPF[3];    // Q8
+    static int32_t  accz_smooth;    // Q8
+#else
     static float    accelLPF[3];
-    static int32_t  accelZoffset;
     static float    accz_smooth;
-    static int16_t  accelZero[3];
-    static int32_t  a[3];
-    static int16_t  accelSmooth[3];
     static float    EstG[3];
     static float    EstN[3] = { 1.0f, 0.0f, 0.0f };
-    static int16_t  gyroZero[3];
+#endif
+    static int32_t  accelZoffset;
+    static int16_t  accelZero[3];
+    static int32_t  a[3];
     static uint32_t previousTime;
 
     int32_t accMag = 0;
-    float rpy[3];
-    float accel_ned[3];
-    float deltaGyroAngle[3];
-    uint32_t deltaT_usec = currentTime - previousTime;
-    float deltaT_sec = deltaT_usec * 0.000001f; 
-    float scale = deltaT_sec* this->gyroScale; 
+    int64_t gyroIntegral[3];
+    uint32_t deltaT_usec;
 
     // calculate RC time constant used in the this->accelZ lpf    
     int16_t  accelADC[3];
-    float anglerad[3];
-
-    previousTime = currentTime;
 
-    Board::imuRead(accelADC, this->gyroADC);
+    if (CONFIG_IMU_RING) {
+        // nothing new since last time
+        if (!this->readRing(accelADC, gyroIntegral, deltaT_usec))
+            return;
+    }
+    else {
+        int16_t gyroSample[3];
+        deltaT_usec = currentTime - previousTime;
+        previousTime = currentTime;
+        Board::imuRead(accelADC, gyroSample);
+        // as from the ring, attitude integrates the raw sample and the PID gets it filtered
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            gyroIntegral[axis] = (int64_t)gyroSample[axis] * deltaT_usec;
+            this->gyroRaw[axis] = (int16_t)FILTER_TO_INT(this->filterGyro(axis, gyroSample[axis]));
+        }
+    }
 
     if (calibratingA > 0) {
 
@@ -204,11 +604,12 @@ void IMU::update(uint32_t currentTime, bool armed, uint16_t & calibratingA, uint
                 devClear(&var[axis]);
             }
             // Sum up 1000 readings
-            g[axis] += this->gyroADC[axis];
-            devPush(&var[axis], this->gyroADC[axis]);
+            g[axis] += this->gyroRaw[axis];
+            devPush(&var[axis], this->gyroRaw[axis]);
             // Clear global variables for next reading
-            this->gyroADC[axis] = 0;
-            gyroZero[axis] = 0;
+            this->gyroRaw[axis] = 0;
+            gyroIntegral[axis] = 0;
+            this->gyroZero[axis] = 0;
             if (calibratingG == 1) {
                 float dev = devStandardDeviation(&var[axis]);
                 // check deviation and startover if idiot was moving the model
@@ -220,66 +621,100 @@ void IMU::update(uint32_t currentTime, bool armed, uint16_t & calibratingA, uint
                     g[0] = g[1] = g[2] = 0;
                     continue;
                 }
-                gyroZero[axis] = (g[axis] + (this->calibratingGyroCycles / 2)) / this->calibratingGyroCycles;
+                this->gyroZero[axis] = (g[axis] + (this->calibratingGyroCycles / 2)) / this->calibratingGyroCycles;
             }
         }
         calibratingG--;
     }
 
     for (uint8_t axis = 0; axis < 3; axis++)
-        this->gyroADC[axis] -= gyroZero[axis];
+        this->gyroADC[axis] = this->gyroRaw[axis] - this->gyroZero[axis];
 
     // Initialization
     for (uint8_t axis = 0; axis < 3; axis++) {
-        deltaGyroAngle[axis] = this->gyroADC[axis] * scale;
+        gyroIntegral[axis] -= (int64_t)this->gyroZero[axis] * deltaT_usec;
         if (CONFIG_ACC_LPF_FACTOR > 0) {
+#ifdef FIXED_POINT
+            accelLPF[axis] += (((int32_t)accelADC[axis] << 8) - accelLPF[axis]) / CONFIG_ACC_LPF_FACTOR;
+            this->accelSmooth[axis] = (int16_t)(accelLPF[axis] / 256);
+#else
             accelLPF[axis] = accelLPF[axis] * (1.0f - (1.0f / CONFIG_ACC_LPF_FACTOR)) + accelADC[axis] * 
                 (1.0f / CONFIG_ACC_LPF_FACTOR);
-            accelSmooth[axis] = (int16_t)accelLPF[axis];
+            this->accelSmooth[axis] = (int16_t)accelLPF[axis];
+#endif
         } else {
-            accelSmooth[axis] = accelADC[axis];
+            this->accelSmooth[axis] = accelADC[axis];
         }
-        accMag += (int32_t)accelSmooth[axis] * accelSmooth[axis];
+        accMag += (int32_t)this->accelSmooth[axis] * this->accelSmooth[axis];
     }
 
     accMag = accMag * 100 / ((int32_t)this->acc1G * this->acc1G);
 
-    rotateV(EstG, deltaGyroAngle);
-
-    // Apply complementary filter (Gyro drift correction)
-    // If accel magnitude >1.15G or <0.85G and ACC vector outside of the limit
-    // range => we neutralize the effect of accelerometers in the angle
-    // estimation.  To do that, we just skip filter, as EstV already rotated by Gyro
-    if (72 < (uint16_t)accMag && (uint16_t)accMag < 133) 
-        for (uint8_t axis = 0; axis < 3; axis++)
-            EstG[axis] = (EstG[axis] * (float)CONFIG_GYRO_CMPF_FACTOR + accelSmooth[axis]) * INV_GYR_CMPF_FACTOR;
+    bool accelValid = 72 < (uint16_t)accMag && (uint16_t)accMag < 133;
 
-    // Attitude of the estimated vector
-    anglerad[AXIS_ROLL] = atan2f(EstG[Y], EstG[Z]);
-    anglerad[AXIS_PITCH] = atan2f(-EstG[X], sqrtf(EstG[Y] * EstG[Y] + EstG[Z] * EstG[Z]));
+#ifdef FIXED_POINT
+    int32_t deltaGyroAngle[3];
+    int32_t angleCentidegrees[3];
+    int32_t accel_ned[3];
 
-    rotateV(EstN, deltaGyroAngle);
-    normalizeV(EstN, EstN);
-
-    // Calculate heading
-    float cosineRoll = cosf(anglerad[AXIS_ROLL]);
-    float sineRoll = sinf(anglerad[AXIS_ROLL]);
-    float cosinePitch = cosf(anglerad[AXIS_PITCH]);
-    float sinePitch = sinf(anglerad[AXIS_PITCH]);
-    float Xh = EstN[X] * cosinePitch + EstN[Y] * sineRoll * sinePitch + EstN[Z] * sinePitch * cosineRoll;
-    float Yh = EstN[Y] * cosineRoll - EstN[Z] * sineRoll;
-    anglerad[AXIS_YAW] = atan2f(Yh, Xh); 
+    // counts times usec to Q30 radians, rounding
+    for (uint8_t axis = 0; axis < 3; axis++)
+        deltaGyroAngle[axis] = (int32_t)((gyroIntegral[axis] * this->gyroScaleQ52 + (1 << 21)) >> 22);
 
-    // the accel values have to be rotated into the earth frame
-    rpy[0] = -(float)anglerad[AXIS_ROLL];
-    rpy[1] = -(float)anglerad[AXIS_PITCH];
-    rpy[2] = -(float)anglerad[AXIS_YAW];
+    // only the Mahony estimator has a fixed-point version
+    this->mahonyUpdate(deltaGyroAngle, this->accelSmooth, accelValid, deltaT_usec, angleCentidegrees, accel_ned);
+#else
+    float deltaT_sec = deltaT_usec * 0.000001f; 
+    float deltaGyroAngle[3];
+    float anglerad[3];
+    float accel_ned[3];
+    float rpy[3];
 
-    accel_ned[X] = accelSmooth[0];
-    accel_ned[Y] = accelSmooth[1];
-    accel_ned[Z] = accelSmooth[2];
+    for (uint8_t axis = 0; axis < 3; axis++)
+        deltaGyroAngle[axis] = gyroIntegral[axis] * (this->gyroScale * 0.000001f);
 
-    rotateV(accel_ned, rpy);
+    if (CONFIG_ATTITUDE_ESTIMATOR == ESTIMATOR_MAHONY) {
+        this->mahonyUpdate(deltaGyroAngle, this->accelSmooth, accelValid, deltaT_sec, anglerad, accel_ned);
+    }
+    else {
+        rotateV(EstG, deltaGyroAngle);
+
+        // Apply complementary filter (Gyro drift correction)
+        // If accel magnitude >1.15G or <0.85G and ACC vector outside of the limit
+        // range => we neutralize the effect of accelerometers in the angle
+        // estimation.  To do that, we just skip filter, as EstV already rotated by Gyro
+        if (accelValid)
+            for (uint8_t axis = 0; axis < 3; axis++)
+                EstG[axis] = (EstG[axis] * (float)CONFIG_GYRO_CMPF_FACTOR + this->accelSmooth[axis]) * INV_GYR_CMPF_FACTOR;
+
+        // Attitude of the estimated vector
+        anglerad[AXIS_ROLL] = ATAN2F(EstG[Y], EstG[Z]);
+        anglerad[AXIS_PITCH] = ATAN2F(-EstG[X], SQRTF(EstG[Y] * EstG[Y] + EstG[Z] * EstG[Z]));
+
+        rotateV(EstN, deltaGyroAngle);
+        normalizeV(EstN, EstN);
+
+        // Calculate heading
+        float cosineRoll = COSF(anglerad[AXIS_ROLL]);
+        float sineRoll = SINF(anglerad[AXIS_ROLL]);
+        float cosinePitch = COSF(anglerad[AXIS_PITCH]);
+        float sinePitch = SINF(anglerad[AXIS_PITCH]);
+        float Xh = EstN[X] * cosinePitch + EstN[Y] * sineRoll * sinePitch + EstN[Z] * sinePitch * cosineRoll;
+        float Yh = EstN[Y] * cosineRoll - EstN[Z] * sineRoll;
+        anglerad[AXIS_YAW] = ATAN2F(Yh, Xh); 
+
+        // the accel values have to be rotated into the earth frame
+        rpy[0] = -(float)anglerad[AXIS_ROLL];
+        rpy[1] = -(float)anglerad[AXIS_PITCH];
+        rpy[2] = -(float)anglerad[AXIS_YAW];
+
+        accel_ned[X] = this->accelSmooth[0];
+        accel_ned[Y] = this->accelSmooth[1];
+        accel_ned[Z] = this->accelSmooth[2];
+
+        rotateV(accel_ned, rpy);
+    }
+#endif
 
     if (!armed) {
         accelZoffset -= accelZoffset / 64;
@@ -287,6 +722,18 @@ void IMU::update(uint32_t currentTime, bool armed, uint16_t & calibratingA, uint
     }
     accel_ned[Z] -= accelZoffset / 64;  // compensate for gravitation on z-axis
 
+#ifdef FIXED_POINT
+    // low pass filter, with gain deltaT / (RC + deltaT) in Q16
+    uint32_t lpfDeltaT = deltaT_usec < 32768 ? deltaT_usec : 32767;
+    int32_t  lpfGain = (lpfDeltaT << 16) / (this->fcAccUsec + lpfDeltaT);
+    accz_smooth += (int32_t)(((int64_t)((accel_ned[Z] << 8) - accz_smooth) * lpfGain) >> 16);
+
+    // apply Deadband to reduce integration drift and vibration influence and
+    // sum up Values for later integration to get velocity and distance
+    this->accelSum[X] += deadbandFilter(accel_ned[X], CONFIG_ACCXY_DEADBAND);
+    this->accelSum[Y] += deadbandFilter(accel_ned[Y], CONFIG_ACCXY_DEADBAND);
+    this->accelSum[Z] += deadbandFilter((accz_smooth + 128) >> 8, CONFIG_ACCZ_DEADBAND);
+#else
     accz_smooth = accz_smooth + (deltaT_sec / (fcAcc + deltaT_sec)) * (accel_ned[Z] - accz_smooth); // low pass filter
 
     // apply Deadband to reduce integration drift and vibration influence and
@@ -294,14 +741,24 @@ void IMU::update(uint32_t currentTime, bool armed, uint16_t & calibratingA, uint
     this->accelSum[X] += deadbandFilter((int32_t)lrintf(accel_ned[X]), CONFIG_ACCXY_DEADBAND);
     this->accelSum[Y] += deadbandFilter((int32_t)lrintf(accel_ned[Y]), CONFIG_ACCXY_DEADBAND);
     this->accelSum[Z] += deadbandFilter((int32_t)lrintf(accz_smooth), CONFIG_ACCZ_DEADBAND);
+#endif
 
     this->accelTimeSum += deltaT_usec;
     this->accelSumCount++;
 
+#ifdef FIXED_POINT
+    // Convert angles from hundredths to tenths of a degree, rounding
+    for (uint8_t axis = 0; axis < 3; axis++)
+        angleCentidegrees[axis] = (angleCentidegrees[axis] + (angleCentidegrees[axis] < 0 ? -5 : 5)) / 10;
+    this->angle[AXIS_ROLL]  = (int16_t)angleCentidegrees[AXIS_ROLL];
+    this->angle[AXIS_PITCH] = (int16_t)angleCentidegrees[AXIS_PITCH];
+    this->angle[AXIS_YAW]   = (int16_t)((angleCentidegrees[AXIS_YAW] + CONFIG_MAGNETIC_DECLINATION) / 10);
+#else
     // Convert angles from radians to tenths of a degrees
     this->angle[AXIS_ROLL]  = (int16_t)lrintf(anglerad[AXIS_ROLL]  * (1800.0f / M_PI));
     this->angle[AXIS_PITCH] = (int16_t)lrintf(anglerad[AXIS_PITCH] * (1800.0f / M_PI));
     this->angle[AXIS_YAW]   = (int16_t)(lrintf(anglerad[AXIS_YAW]   * 1800.0f / M_PI + CONFIG_MAGNETIC_DECLINATION) / 10.0f);
+#endif
 
     // Convert heading from [-180,+180] to [0,360]
     if (this->angle[AXIS_YAW] < 0)
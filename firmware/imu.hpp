@@ -30,6 +30,45 @@ enum {
 #define CONFIG_GYRO_CMPF_FACTOR   600    
 #define CONFIG_GYRO_CMPFM_FACTOR  250  
 #define CONFIG_MORON_THRESHOLD     32
+#define CONFIG_IMU_RING            1    // timestamped samples at CONFIG_GYRO_SAMPLE_HZ; 0 polls once per loop
+
+// Gyro anti-alias filter, run on every ring sample before decimating to the loop rate
+enum {
+    GYRO_DECIMATOR_AVERAGE = 0,
+    GYRO_DECIMATOR_FIR,
+    GYRO_DECIMATOR_BIQUAD
+};
+
+#define CONFIG_GYRO_DECIMATOR     GYRO_DECIMATOR_BIQUAD
+#define CONFIG_GYRO_SAMPLE_HZ     1000  // data-ready rate of the MPU parts, and of the sample task
+#define CONFIG_GYRO_LPF_HZ        100
+#define CONFIG_GYRO_FIR_TAPS      9
+
+// Gyro notch at the sample rate (the loop rate on a polled gyro), ahead of the decimator, for motor
+// noise above the loop's Nyquist rate.  Only the gyro passed to the PID is notched; attitude
+// integrates the raw samples.
+#define CONFIG_GYRO_NOTCH_HZ        0     // 0 to disable; the dynamic notch usually does better
+#define CONFIG_GYRO_NOTCH_CUTOFF_HZ 160
+#define CONFIG_GYRO_DYN_NOTCH       1     // follow the vibration peak found by FFT (see dynnotch.hpp)
+
+// Notches on each motor's rotation frequency and its harmonics, retuned every loop from ESC
+// telemetry.  Off until every motor reports RPM, leaving the notches above as the only ones.
+#define CONFIG_RPM_NOTCH            1
+#define CONFIG_RPM_NOTCH_HARMONICS  2     // fundamental and first harmonic
+#define CONFIG_RPM_NOTCH_MOTORS     8     // motors beyond this are not notched
+#define CONFIG_RPM_NOTCH_Q          5.0f
+#define CONFIG_RPM_NOTCH_MIN_HZ     80    // below this a notch would cut into the control band
+
+// Attitude estimator: baseflight's rotated gravity vector with complementary filter, or a
+// Mahony quaternion filter that integrates gyro without trig
+enum {
+    ESTIMATOR_COMPLEMENTARY = 0,
+    ESTIMATOR_MAHONY
+};
+
+#define CONFIG_ATTITUDE_ESTIMATOR ESTIMATOR_MAHONY
+#define CONFIG_MAHONY_KP          0.5f  // rad/sec of correction per rad of accel error
+#define CONFIG_MAHONY_KI          0.01f
 
 #ifdef __arm__
 extern "C" {
@@ -48,6 +87,54 @@ extern "C" {
             uint16_t acc1G;
             float    fcAcc;
             float    gyroScale;
+            float    gyroSampleHz;      // rate the gyro filters run at
+            ImuRing  ring;
+            uint32_t previousSampleTime;
+            biquad_t gyroBiquad[3];
+            fir_t    gyroFir[3];
+            filterCoeff_t gyroFirCoeffs[CONFIG_GYRO_FIR_TAPS];
+            biquad_t gyroNotch[3];
+            bool     gyroNotchEnabled;
+            DynamicNotch dynNotch;
+#if CONFIG_RPM_NOTCH
+            biquad_t rpmNotch[CONFIG_RPM_NOTCH_MOTORS][CONFIG_RPM_NOTCH_HARMONICS][3];
+            bool     rpmNotchActive[CONFIG_RPM_NOTCH_MOTORS][CONFIG_RPM_NOTCH_HARMONICS];
+            uint8_t  rpmNotchMotors;
+            float    rpmNotchCutoffRatio;
+#endif
+
+#ifdef FIXED_POINT
+            int32_t  quat[4];           // Q30
+            int32_t  integralError[3];  // Q30 rad/sec
+            int64_t  gyroScaleQ52;      // rad per gyro count-microsecond
+            int32_t  fcAccUsec;
+
+            void mahonyUpdate(int32_t deltaGyroAngle[3], int16_t accelSmooth[3], bool useAccel, uint32_t deltaT_usec,
+                    int32_t angleCentidegrees[3], int32_t accel_ned[3]);
+#else
+            float    quat[4];
+            float    integralError[3];
+
+            void mahonyUpdate(float deltaGyroAngle[3], int16_t accelSmooth[3], bool useAccel, float deltaT_sec,
+                    float anglerad[3], float accel_ned[3]);
+#endif
+
+            // filtered gyro before zero removal, and the calibrated zero
+            int16_t  gyroRaw[3];
+            int16_t  gyroZero[3];
+
+            // ring samples drained since the last attitude update
+            int32_t  ringAccelSum[3];
+            int64_t  ringGyroIntegral[3];
+            uint16_t ringCount;
+            uint32_t ringFirstTime;
+
+            filterSample_t filterGyro(uint8_t axis, int16_t gyroADC);
+
+            void drainRing(void);
+
+            // gyro is integrated as counts times microseconds
+            bool readRing(int16_t accelADC[3], int64_t gyroIntegral[3], uint32_t & deltaT_usec);
 
         public:
 
@@ -55,12 +142,37 @@ extern "C" {
             int16_t  angle[3];
             int16_t  gyroADC[3];
 
+            // low-passed and zeroed, for the blackbox
+            int16_t  accelSmooth[3];
+
+            // the board has no data-ready interrupt, so the sample task must feed the ring
+            bool     sampleTask;
+
+            // called from the sample task, in place of the data-ready interrupt
+            void sample(uint32_t currentTime);
+
             // called from MW
-            void init(uint16_t calibratingGyroCycles, uint16_t calibratingAccCycles);
+            void init(uint16_t calibratingGyroCycles, uint16_t calibratingAccCycles, uint32_t looptimeUsec);
             void update(uint32_t currentTime, bool armed, uint16_t & calibratingA, uint16_t & calibratingG);
 
             // called from Hover
             float computeAccelZ(void);
+
+            // called from PidController
+            float gyroDegreesPerSecondPerCount(void);
+            float gyroDegreesPerSecond(uint8_t axis);
+
+            // refreshes gyroADC from the ring between attitude updates, for a faster rate loop
+            void updateGyro(void);
+
+            // moves the gyro notch, keeping filter state; centerHz = 0 turns it off
+            void setGyroNotch(float centerHz, float cutoffHz);
+
+            // retunes the RPM notches once per loop; valid = false turns them off
+            void setMotorRpm(const uint16_t rpm[], uint8_t motorCount, bool valid);
+
+            // background slice of the dynamic notch's spectrum analysis
+            void updateDynamicNotch(void);
     };
 
 #ifdef __arm__
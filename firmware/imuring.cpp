@@ -0,0 +1,72 @@
+/*
+   imuring.cpp : Ring buffer of timestamped IMU samples, class implementation
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+void ImuRing::init(void)
+{
+    this->head = 0;
+    this->tail = 0;
+    this->overruns = 0;
+}
+
+void ImuRing::push(uint32_t usec, int16_t accADC[3], int16_t gyroADC[3])
+{
+    uint8_t next = (this->head + 1) & (IMU_RING_SIZE - 1);
+
+    // full: drop the new sample rather than touch the consumer's index
+    if (next == this->tail) {
+        this->overruns++;
+        return;
+    }
+
+    imuSample_t * sample = &this->samples[this->head];
+
+    sample->usec = usec;
+    for (uint8_t k=0; k<3; ++k) {
+        sample->accADC[k]  = accADC[k];
+        sample->gyroADC[k] = gyroADC[k];
+    }
+
+    MEMORY_BARRIER();
+
+    this->head = next;
+}
+
+bool ImuRing::pop(imuSample_t & sample)
+{
+    if (this->tail == this->head)
+        return false;
+
+    MEMORY_BARRIER();
+
+    sample = this->samples[this->tail];
+
+    MEMORY_BARRIER();
+
+    this->tail = (this->tail + 1) & (IMU_RING_SIZE - 1);
+
+    return true;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,60 @@
+/*
+   imuring.hpp : Ring buffer of timestamped IMU samples, class header
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Must be a power of two; at 1kHz sampling this holds 16msec of data
+#define IMU_RING_SIZE 16
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    typedef struct imuSample_t {
+        uint32_t usec;
+        int16_t  accADC[3];
+        int16_t  gyroADC[3];
+    } imuSample_t;
+
+    // Single producer (the board's data-ready interrupt, or the sample task on boards without
+    // one), single consumer (IMU::update).
+    // Each index is written by one side only, so no locking is needed.
+    class ImuRing {
+
+        private:
+
+            imuSample_t      samples[IMU_RING_SIZE];
+            volatile uint8_t head;
+            volatile uint8_t tail;
+
+        public:
+
+            // samples dropped because the consumer fell behind
+            volatile uint32_t overruns;
+
+            void init(void);
+
+            // called from interrupt or the sample task
+            void push(uint32_t usec, int16_t accADC[3], int16_t gyroADC[3]);
+
+            // called from loop
+            bool pop(imuSample_t & sample);
+    };
+
+#ifdef __arm__
+} // extern "C"
+#endif
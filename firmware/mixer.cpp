@@ -25,14 +25,6 @@ extern "C" {
 
 #include "hackflight.hpp"
 
-// Custom mixer data per motor
-typedef struct motorMixer_t {
-    float throttle;
-    float roll;
-    float pitch;
-    float yaw;
-} motorMixer_t;
-
 static const motorMixer_t mixerQuadX[] = {
     { 1.0f, -1.0f,  1.0f, -1.0f },          // REAR_R
     { 1.0f, -1.0f, -1.0f,  1.0f },          // FRONT_R
@@ -40,53 +32,188 @@ static const motorMixer_t mixerQuadX[] = {
     { 1.0f,  1.0f, -1.0f, -1.0f },          // FRONT_L
 };
 
-void Mixer::init(class RC * _rc, class Stabilize * _stabilize)
+static const motorMixer_t mixerHex6X[] = {
+    { 1.0f, -0.5f,  0.866025f,  1.0f },     // REAR_R
+    { 1.0f, -0.5f, -0.866025f,  1.0f },     // FRONT_R
+    { 1.0f,  0.5f,  0.866025f, -1.0f },     // REAR_L
+    { 1.0f,  0.5f, -0.866025f, -1.0f },     // FRONT_L
+    { 1.0f, -1.0f,  0.0f,      -1.0f },     // RIGHT
+    { 1.0f,  1.0f,  0.0f,       1.0f },     // LEFT
+};
+
+static const motorMixer_t mixerY6[] = {
+    { 1.0f,  0.0f,  1.333333f,  1.0f },     // REAR
+    { 1.0f, -1.0f, -0.666667f, -1.0f },     // RIGHT
+    { 1.0f,  1.0f, -0.666667f, -1.0f },     // LEFT
+    { 1.0f,  0.0f,  1.333333f, -1.0f },     // UNDER_REAR
+    { 1.0f, -1.0f, -0.666667f,  1.0f },     // UNDER_RIGHT
+    { 1.0f,  1.0f, -0.666667f,  1.0f },     // UNDER_LEFT
+};
+
+static const motorMixer_t mixerOctoX8[] = {
+    { 1.0f, -1.0f,  1.0f, -1.0f },          // REAR_R
+    { 1.0f, -1.0f, -1.0f,  1.0f },          // FRONT_R
+    { 1.0f,  1.0f,  1.0f,  1.0f },          // REAR_L
+    { 1.0f,  1.0f, -1.0f, -1.0f },          // FRONT_L
+    { 1.0f, -1.0f,  1.0f,  1.0f },          // UNDER_REAR_R
+    { 1.0f, -1.0f, -1.0f, -1.0f },          // UNDER_FRONT_R
+    { 1.0f,  1.0f,  1.0f, -1.0f },          // UNDER_REAR_L
+    { 1.0f,  1.0f, -1.0f,  1.0f },          // UNDER_FRONT_L
+};
+
+#define MIXER_ROWS(m) m, sizeof(m) / sizeof(m[0])
+
+void Mixer::init(class RC * _rc, Controller * _stabilize)
 {
     this->stabilize = _stabilize;
     this->rc = _rc;
 
     // set disarmed motor values
-    for (uint8_t i = 0; i < 4; i++)
+    for (uint8_t i = 0; i < CONFIG_MAX_MOTORS; i++) {
         this->motorsDisarmed[i] = CONFIG_PWM_MIN;
+        this->motorRpm[i] = 0;
+    }
+    this->rpmValid = false;
+
+    // thrust goes as the square of motor speed, and roughly of PWM
+    for (uint8_t k = 0; k < CONFIG_THRUST_CURVE_POINTS; k++)
+        this->thrustCurve[k] = sqrtf((float)k / (CONFIG_THRUST_CURVE_POINTS - 1));
+
+    // a frame with more motors than the board has outputs leaves them all stopped
+    this->motorCount = 0;
+
+#if CONFIG_MIXER == MIXER_HEX6X
+    this->load(MIXER_ROWS(mixerHex6X));
+#elif CONFIG_MIXER == MIXER_Y6
+    this->load(MIXER_ROWS(mixerY6));
+#elif CONFIG_MIXER == MIXER_OCTOX8
+    this->load(MIXER_ROWS(mixerOctoX8));
+#else
+    this->load(MIXER_ROWS(mixerQuadX));
+#endif
 }
 
+bool Mixer::load(const motorMixer_t * rows, uint8_t count)
+{
+    if (count > CONFIG_MAX_MOTORS || count > Board::motorCount())
+        return false;
+
+    // stop any outputs the new frame doesn't use
+    for (uint8_t i = count; i < this->motorCount; i++)
+        Board::writeMotor(i, CONFIG_PWM_MIN);
+
+    for (uint8_t i = 0; i < CONFIG_MAX_MOTORS; i++) {
+        bool used = i < count;
+        this->mixThrottle[i] = used ? rows[i].throttle : 0;
+        this->mixRoll[i]     = used ? rows[i].roll     : 0;
+        this->mixPitch[i]    = used ? rows[i].pitch    : 0;
+        this->mixYaw[i]      = used ? rows[i].yaw      : 0;
+    }
+
+    this->motorCount = count;
+
+    return true;
+}
+
+void Mixer::getRow(uint8_t index, motorMixer_t & row)
+{
+    row.throttle = this->mixThrottle[index];
+    row.roll     = this->mixRoll[index];
+    row.pitch    = this->mixPitch[index];
+    row.yaw      = this->mixYaw[index];
+}
+
+#if CONFIG_THRUST_LINEARIZATION
+static float linearize(const float curve[CONFIG_THRUST_CURVE_POINTS], float thrust)
+{
+    float x = thrust * (CONFIG_THRUST_CURVE_POINTS - 1);
+    int8_t k = (int8_t)x;
+    if (k >= CONFIG_THRUST_CURVE_POINTS - 1)
+        return curve[CONFIG_THRUST_CURVE_POINTS - 1];
+    return curve[k] + (x - k) * (curve[k+1] - curve[k]);
+}
+#endif
+
 void Mixer::update(bool armed)
 {
-    int16_t maxMotor;
-    int16_t motors[4];
+    float correction[CONFIG_MAX_MOTORS];
+    float mix[CONFIG_MAX_MOTORS];
+
+    float throttle = this->rc->command[DEMAND_THROTTLE];
+    float roll     = this->stabilize->axisPID[AXIS_ROLL];
+    float pitch    = this->stabilize->axisPID[AXIS_PITCH];
+    float yaw      = -CONFIG_YAW_DIRECTION * this->stabilize->axisPID[AXIS_YAW];
+
+    // unused columns are zero, so a fixed-length loop costs nothing and vectorizes fully
+    for (uint8_t i = 0; i < CONFIG_MAX_MOTORS; i++)
+        correction[i] = roll * this->mixRoll[i] + pitch * this->mixPitch[i] + yaw * this->mixYaw[i];
+
+#if CONFIG_AIRMODE
+    // a correction wider than the whole motor range keeps its shape, scaled down to fit
+    float minCorrection = correction[0];
+    float maxCorrection = correction[0];
+    for (uint8_t i = 1; i < this->motorCount; i++) {
+        minCorrection = min(minCorrection, correction[i]);
+        maxCorrection = max(maxCorrection, correction[i]);
+    }
+
+    float spread = maxCorrection - minCorrection;
+    float scale = spread > CONFIG_PWM_MAX - CONFIG_PWM_MIN ? (CONFIG_PWM_MAX - CONFIG_PWM_MIN) / spread : 1;
+#else
+    float scale = 1;
+#endif
+
+    for (uint8_t i = 0; i < CONFIG_MAX_MOTORS; i++)
+        mix[i] = throttle * this->mixThrottle[i] + scale * correction[i];
 
-    for (uint8_t i = 0; i < 4; i++)
-        motors[i] = (int16_t)
-            (this->rc->command[DEMAND_THROTTLE] * mixerQuadX[i].throttle + 
-             this->stabilize->axisPID[AXIS_PITCH] * mixerQuadX[i].pitch + 
-            this->stabilize->axisPID[AXIS_ROLL] * mixerQuadX[i].roll - 
-            CONFIG_YAW_DIRECTION * this->stabilize->axisPID[AXIS_YAW] * mixerQuadX[i].yaw);
+    float minMotor = mix[0];
+    float maxMotor = mix[0];
+    for (uint8_t i = 1; i < this->motorCount; i++) {
+        minMotor = min(minMotor, mix[i]);
+        maxMotor = max(maxMotor, mix[i]);
+    }
 
-    maxMotor = motors[0];
+    // this is a way to still have good gyro corrections if at least one motor reaches its max;
+    // in airmode, likewise at its min, trading collective thrust for attitude control
+    float shift = 0;
+    if (maxMotor > CONFIG_PWM_MAX)
+        shift = CONFIG_PWM_MAX - maxMotor;
+#if CONFIG_AIRMODE
+    else if (minMotor < CONFIG_PWM_MIN)
+        shift = CONFIG_PWM_MIN - minMotor;
+#endif
 
-    for (uint8_t i = 1; i < 4; i++)
-        if (motors[i] > maxMotor)
-            maxMotor = motors[i];
+    for (uint8_t i = 0; i < this->motorCount; i++) {
 
-    for (uint8_t i = 0; i < 4; i++) {
+        float motor = mix[i] + shift;
 
-        if (maxMotor > CONFIG_PWM_MAX)     
-            // this is a way to still have good gyro corrections if at least one motor reaches its max.
-            motors[i] -= maxMotor - CONFIG_PWM_MAX;
+#if CONFIG_THRUST_LINEARIZATION
+        float thrust = (motor - CONFIG_PWM_MIN) / (CONFIG_PWM_MAX - CONFIG_PWM_MIN);
+        thrust = constrain(thrust, 0, 1);
+        motor = CONFIG_PWM_MIN + (CONFIG_PWM_MAX - CONFIG_PWM_MIN) * linearize(this->thrustCurve, thrust);
+#endif
 
-        motors[i] = constrain(motors[i], CONFIG_PWM_MIN, CONFIG_PWM_MAX);
+        this->motors[i] = constrain((int16_t)motor, CONFIG_PWM_MIN, CONFIG_PWM_MAX);
 
         if (this->rc->throttleIsDown()) {
-            motors[i] = CONFIG_PWM_MIN;
+            this->motors[i] = CONFIG_PWM_MIN;
         } 
 
         if (!armed) {
-            motors[i] = motorsDisarmed[i];
+            this->motors[i] = this->motorsDisarmed[i];
         }
     }
 
-    for (uint8_t i = 0; i < 4; i++)
-        Board::writeMotor(i, motors[i]);
+    for (uint8_t i = 0; i < this->motorCount; i++)
+        Board::writeMotor(i, this->motors[i]);
+
+    Board::completeMotorUpdate();
+
+    // a motor whose reply was lost keeps its last speed
+    this->rpmValid = this->motorCount > 0;
+    for (uint8_t i = 0; i < this->motorCount; i++)
+        if (!Board::motorRpm(i, this->motorRpm[i]))
+            this->rpmValid = false;
 }
 
 #ifdef __arm__
@@ -19,22 +19,72 @@
 
 #define CONFIG_YAW_DIRECTION     1
 
+#define CONFIG_MAX_MOTORS        8
+
+// Built-in frames; build with e.g. OPTIONS=CONFIG_MIXER=MIXER_HEX6X, or load any other over MSP
+#define MIXER_QUADX              0
+#define MIXER_HEX6X              1
+#define MIXER_Y6                 2
+#define MIXER_OCTOX8             3
+
+#ifndef CONFIG_MIXER
+#define CONFIG_MIXER             MIXER_QUADX
+#endif
+
+// Shift, and if need be scale, the outputs so the whole PID correction fits in the motor range;
+// off keeps the baseline mixer, which shifts outputs down from the max but clips them at the min
+#define CONFIG_AIRMODE                  0
+
+// Map demanded thrust through thrustCurve[] to PWM; off keeps pidvals.hpp tuned against raw PWM
+#define CONFIG_THRUST_LINEARIZATION     0
+#define CONFIG_THRUST_CURVE_POINTS      9
+
 #ifdef __arm__
 extern "C" {
 #endif
 
+    // Contribution of each demand to one motor
+    typedef struct motorMixer_t {
+        float throttle;
+        float roll;
+        float pitch;
+        float yaw;
+    } motorMixer_t;
+
     class Mixer {
 
         private:
 
             class RC        * rc;
-            class Stabilize * stabilize;
+            Controller      * stabilize;
+
+            // mixer matrix by column, so that each demand is one pass over the motors
+            float mixThrottle[CONFIG_MAX_MOTORS];
+            float mixRoll[CONFIG_MAX_MOTORS];
+            float mixPitch[CONFIG_MAX_MOTORS];
+            float mixYaw[CONFIG_MAX_MOTORS];
         
         public:
 
-            int16_t  motorsDisarmed[4];
+            uint8_t  motorCount;
+            int16_t  motorsDisarmed[CONFIG_MAX_MOTORS];
+
+            // last values written, for the blackbox
+            int16_t  motors[CONFIG_MAX_MOTORS];
+
+            // PWM fraction giving each evenly spaced fraction of full thrust
+            float    thrustCurve[CONFIG_THRUST_CURVE_POINTS];
+
+            // from ESC telemetry, where the board has it; rpmValid when every motor answered last update
+            uint16_t motorRpm[CONFIG_MAX_MOTORS];
+            bool     rpmValid;
+
+            void init(class RC * _rc, Controller * _stabilize);
+
+            // false, leaving the current matrix, if the board can't drive that many motors
+            bool load(const motorMixer_t * rows, uint8_t count);
 
-            void init(class RC * _rc, class Stabilize * _stabilize);
+            void getRow(uint8_t index, motorMixer_t & row);
 
             void update(bool armed);
     };
@@ -30,22 +30,92 @@ extern "C" {
 #define MSP_RC                   105    
 #define MSP_ATTITUDE             108    
 #define MSP_ALTITUDE             109    
+#define MSP_LOOP_TIMING          121
+#define MSP_LOOP_HISTOGRAM       122
+#define MSP_TASKS                123
+#define MSP_GAIN_TABLE           124
+#define MSP_AUTOTUNE             125
 #define MSP_BARO_SONAR_RAW       126    
 #define MSP_SONARS               127    
+#define MSP_MIXER                128
+#define MSP_MOTOR_RPM            129
+#define MSP_TELEMETRY            130
+#define MSP_TELEMETRY_DELTA      131
+#define MSP_BLACKBOX             132
 #define MSP_SET_RAW_RC           200    
 #define MSP_SET_HEAD             211
+#define MSP_SET_LOOP_TIMING      221
+#define MSP_SET_GAIN_TABLE       224
+#define MSP_SET_MIXER            228
+#define MSP_SET_TELEMETRY        230
 #define MSP_SET_MOTOR            214    
 
+// MSPv2 replaces the XOR checksum with CRC-8/DVB-S2 (polynomial 0xD5)
+static uint8_t crc8DvbS2(uint8_t crc, uint8_t a)
+{
+    crc ^= a;
+    for (uint8_t k = 0; k < 8; k++)
+        crc = (crc & 0x80) ? (crc << 1) ^ 0xD5 : crc << 1;
+    return crc;
+}
+
+static uint8_t checksum8(uint8_t version, uint8_t checksum, uint8_t a)
+{
+    return (version == 2) ? crc8DvbS2(checksum, a) : checksum ^ a;
+}
+
+void MSP::put8(uint8_t a)
+{
+    if (this->outCount < OUTBUF_SIZE)
+        this->outBuf[this->outCount++] = a;
+}
+
+// seven bits at a time, low first, with the top bit set on all but the last byte
+void MSP::putVarint(uint32_t a)
+{
+    while (a >= 0x80) {
+        put8(a | 0x80);
+        a >>= 7;
+    }
+    put8(a);
+}
+
+// The change is taken modulo the field's width and zigzag-mapped, so small steps either way,
+// including a counter wrapping, cost one byte
+void MSP::serializeField(uint32_t a, uint8_t width)
+{
+    uint32_t ref = 0;
+
+    if (this->fieldRef) {
+        for (uint8_t k = 0; k < width; k++) {
+            ref |= (uint32_t)this->fieldRef[k] << (8*k);
+            this->fieldRef[k] = a >> (8*k);
+        }
+        this->fieldRef += width;
+    }
+
+    uint8_t shift = 32 - 8*width;
+    int32_t delta = (int32_t)((a - ref) << shift) >> shift;
+
+    putVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+}
+
 void MSP::serialize8(uint8_t a)
 {
-    Board::serialWriteByte(a);
-    portState.checksum ^= a;
+    if (this->fieldCoding)
+        serializeField(a, 1);
+    else
+        put8(a);
 }
 
 void MSP::serialize16(int16_t a)
 {
-    serialize8(a & 0xFF);
-    serialize8((a >> 8) & 0xFF);
+    if (this->fieldCoding)
+        serializeField((uint16_t)a, 2);
+    else {
+        put8(a & 0xFF);
+        put8((a >> 8) & 0xFF);
+    }
 }
 
 uint8_t MSP::read8(void)
@@ -69,55 +139,382 @@ uint32_t MSP::read32(void)
 
 void MSP::serialize32(uint32_t a)
 {
-    serialize8(a & 0xFF);
-    serialize8((a >> 8) & 0xFF);
-    serialize8((a >> 16) & 0xFF);
-    serialize8((a >> 24) & 0xFF);
+    if (this->fieldCoding)
+        serializeField(a, 4);
+    else {
+        put8(a & 0xFF);
+        put8((a >> 8) & 0xFF);
+        put8((a >> 16) & 0xFF);
+        put8((a >> 24) & 0xFF);
+    }
 }
 
-
-void MSP::headSerialResponse(uint8_t err, uint8_t s)
+// The size is left zero here and filled in by tailSerialReply(), which also computes the
+// checksum over what is in outBuf, so building a frame never disturbs the parser's checksum.
+// An MSPv1 frame has only eight bits of size and command.
+void MSP::headFrame(uint8_t version, uint8_t type, uint16_t cmd)
 {
+    this->frameStart = this->outCount;
+    this->frameVersion = version;
+
     serialize8('$');
-    serialize8('M');
-    serialize8(err ? '!' : '>');
-    portState.checksum = 0;               // start calculating a new checksum
-    serialize8(s);
-    serialize8(portState.cmdMSP);
+    serialize8(version == 2 ? 'X' : 'M');
+    serialize8(type);
+    if (version == 2) {
+        serialize8(0);                    // flag
+        serialize16(cmd);
+        serialize16(0);
+    } else {
+        serialize8(0);
+        serialize8(cmd);
+    }
 }
 
-void MSP::headSerialReply(uint8_t s)
+// Replies go out in the version of the request, so MSPv1 tools keep working
+void MSP::headSerialReply(void)
 {
-    headSerialResponse(0, s);
+    headFrame(portState.version, '>', portState.cmdMSP);
 }
 
-void MSP::headSerialError(uint8_t s)
+void MSP::headSerialError(void)
 {
-    headSerialResponse(1, s);
+    headFrame(portState.version, '!', portState.cmdMSP);
 }
 
 void MSP::tailSerialReply(void)
 {
-    serialize8(portState.checksum);
+    uint16_t start = this->frameStart;
+
+    if (this->frameVersion == 2) {
+        uint16_t size = this->outCount - start - 8;
+        this->outBuf[start+6] = size & 0xFF;
+        this->outBuf[start+7] = size >> 8;
+    } else {
+        this->outBuf[start+3] = this->outCount - start - 5;
+    }
+
+    uint8_t checksum = 0;
+    for (uint16_t k = start+3; k < this->outCount; k++)
+        checksum = checksum8(this->frameVersion, checksum, this->outBuf[k]);
+
+    put8(checksum);
+}
+
+// Payload of a message the host can request or subscribe to; false if there is no such message
+bool MSP::serializePayload(uint16_t cmd)
+{
+    switch (cmd) {
+
+        case MSP_RC:
+            for (uint8_t i = 0; i < 8; i++)
+                serialize16(this->rc->data[i]);
+            break;
+
+        case MSP_ATTITUDE:
+            for (uint8_t i = 0; i < 3; i++)
+                serialize16(this->imu->angle[i]);
+            break;
+
+        case MSP_LOOP_TIMING:
+            for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+                serialize16(this->profiler->getMin(i));
+                serialize16(this->profiler->getMax(i));
+                serialize16(this->profiler->getMean(i));
+            }
+            break;
+
+        case MSP_LOOP_HISTOGRAM:
+            serialize8(this->profiler->histogramStage);
+            for (uint8_t i = 0; i < PROFILE_BUCKET_COUNT; i++)
+                serialize32(this->profiler->stages[this->profiler->histogramStage].histogram[i]);
+            break;
+
+        case MSP_TASKS:
+            for (uint8_t i = 0; i < TASK_COUNT; i++) {
+                task_t * task = &this->scheduler->tasks[i];
+                serialize16(task->maxUsec > 65535 ? 65535 : task->maxUsec);
+                serialize16(task->budgetUsec);
+                serialize32(task->deadlineMisses);
+                serialize32(task->deferrals);
+            }
+            break;
+
+        case MSP_GAIN_TABLE:
+            for (uint8_t v = 0; v < GAIN_VOLTAGE_POINTS; v++)
+                serialize16(this->gains->voltageMillivolts[v]);
+            for (uint8_t v = 0; v < GAIN_VOLTAGE_POINTS; v++)
+                for (uint8_t t = 0; t < GAIN_THROTTLE_POINTS; t++)
+                    for (uint8_t k = 0; k < 3; k++)
+                        serialize8(this->gains->percent[v][t][k]);
+            break;
+
+        case MSP_AUTOTUNE:
+            serialize8(this->autotune->state);
+            serialize8(this->autotune->axis);
+            for (uint8_t i = 0; i < 3; i++) {
+                serialize8(this->autotune->rateP[i]);
+                serialize8(this->autotune->rateI[i]);
+                serialize8(this->autotune->rateD[i]);
+                serialize16(this->autotune->periodMsec[i]);
+                serialize16(this->autotune->amplitudeDps[i]);
+            }
+            break;
+
+        case MSP_MIXER:
+            serialize8(this->mixer->motorCount);
+            for (uint8_t i = 0; i < CONFIG_MAX_MOTORS; i++) {
+                motorMixer_t row;
+                this->mixer->getRow(i, row);
+                serialize16((int16_t)lrintf(row.throttle * 1000));
+                serialize16((int16_t)lrintf(row.roll * 1000));
+                serialize16((int16_t)lrintf(row.pitch * 1000));
+                serialize16((int16_t)lrintf(row.yaw * 1000));
+            }
+            break;
+
+        case MSP_MOTOR_RPM:
+            for (uint8_t i = 0; i < CONFIG_MAX_MOTORS; i++)
+                serialize16(this->mixer->motorRpm[i]);
+            break;
+
+        case MSP_BLACKBOX:
+            serialize32(this->blackbox->frames);
+            serialize32(this->blackbox->frameBytes);
+            serialize32(this->blackbox->overruns);
+            break;
+
+        case MSP_ALTITUDE:
+            serialize32(this->hover->estAlt);
+            serialize16(this->hover->vario);
+            break;
+
+        case MSP_SONARS:
+            for (uint8_t i = 0; i < 4; i++)
+                serialize16(this->sonars->distances[i]);
+            break;
+
+        // not yet implemented
+        case MSP_BARO_SONAR_RAW:
+            //serialize32(baroPressure);
+            //serialize32(sonarDistance);
+            return false;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+// Replaces the subscriptions with the request's (message id, period in msec) pairs, and a trailing
+// byte, if any, that selects delta coding.  The whole request is refused if any of its messages
+// can't be streamed; each is tried in outBuf, which has room for a full frame whenever a request
+// is handled, and must fit in a push by itself even if coding doubles it.
+void MSP::setTelemetry(void)
+{
+    telemetrySlot_t slots[CONFIG_MSP_TELEMETRY_SLOTS];
+    memset(slots, 0, sizeof(slots));
+
+    uint8_t count = portState.dataSize / 4;
+    bool delta = (portState.dataSize % 4) && portState.inBuf[portState.dataSize-1];
+    uint16_t maxSize = delta ? (INBUF_SIZE - 6) / 2 : INBUF_SIZE - 3;
+
+    bool ok = count <= CONFIG_MSP_TELEMETRY_SLOTS && portState.dataSize % 4 <= 1;
+
+    uint32_t now = Board::getMicros();
+
+    for (uint8_t k = 0; ok && k < count; k++) {
+        slots[k].cmdMSP = read16();
+        slots[k].periodMsec = read16();
+        slots[k].dueUsec = now;
+        if (slots[k].periodMsec) {
+            uint16_t mark = this->outCount;
+            ok = serializePayload(slots[k].cmdMSP) && this->outCount - mark <= maxSize;
+            slots[k].size = this->outCount - mark;
+            this->outCount = mark;
+        }
+    }
+
+    if (ok) {
+        memcpy(this->telemetry, slots, sizeof(slots));
+        this->telemetryDelta = delta;
+        headSerialReply();
+    }
+    else
+        headSerialError();
+}
+
+// (id, size, payload)
+bool MSP::pushRecord(telemetrySlot_t * slot)
+{
+    uint16_t mark = this->outCount;
+
+    serialize16(slot->cmdMSP);
+    serialize8(0);
+    serializePayload(slot->cmdMSP);
+
+    if (this->outCount - this->frameStart - 8 > INBUF_SIZE) {
+        this->outCount = mark;
+        return false;
+    }
+
+    this->outBuf[mark+2] = this->outCount - mark - 3;
+
+    return true;
+}
+
+// (varint of id and key flag, varint of length, coded fields).  A key record is coded against
+// zero, as is every record of a payload too big to keep.
+bool MSP::pushDeltaRecord(telemetrySlot_t * slot)
+{
+    bool key = slot->untilKey == 0 || slot->size > CONFIG_MSP_TELEMETRY_HISTORY_BYTES;
+
+    uint16_t mark = this->outCount;
+
+    putVarint((uint32_t)slot->cmdMSP << 1 | key);
+    put8(0);
+
+    uint16_t start = this->outCount;
+
+    if (key)
+        memset(slot->history, 0, sizeof(slot->history));
+
+    this->fieldCoding = true;
+    this->fieldRef = slot->size <= CONFIG_MSP_TELEMETRY_HISTORY_BYTES ? slot->history : NULL;
+    serializePayload(slot->cmdMSP);
+    this->fieldCoding = false;
+
+    uint16_t length = this->outCount - start;
+    uint8_t longLength = length >= 0x80;
+
+    if (this->outCount + longLength - this->frameStart - 8 > INBUF_SIZE) {
+        this->outCount = mark;
+        slot->untilKey = 0;     // the history has moved on without the host
+        return false;
+    }
+
+    if (longLength) {
+        memmove(&this->outBuf[start+1], &this->outBuf[start], length);
+        this->outCount++;
+        this->outBuf[start-1] = length | 0x80;
+        this->outBuf[start] = length >> 7;
+    }
+    else
+        this->outBuf[start-1] = length;
+
+    slot->untilKey = key ? CONFIG_MSP_TELEMETRY_KEY_INTERVAL - 1 : slot->untilKey - 1;
+
+    return true;
+}
+
+// Packs every due subscription into one MSPv2 frame of records, in slot order, as far as
+// INBUF_SIZE allows; what doesn't fit stays due for the next push.  A TELEMETRY_DELTA frame
+// starts with a sequence number, so the host can tell when it has missed one.  Each push then
+// holds off the next until its bytes have gone out at the budgeted rate.
+void MSP::pushTelemetry(void)
+{
+    uint32_t now = Board::getMicros();
+
+    if ((int32_t)(now - this->telemetryReadyUsec) < 0 || this->outCount + MAX_FRAME_SIZE > OUTBUF_SIZE)
+        return;
+
+    bool started = false;
+
+    for (uint8_t k = 0; k < CONFIG_MSP_TELEMETRY_SLOTS; k++) {
+
+        telemetrySlot_t * slot = &this->telemetry[k];
+
+        if (!slot->periodMsec || (int32_t)(now - slot->dueUsec) < 0)
+            continue;
+
+        if (!started) {
+            headFrame(2, '>', this->telemetryDelta ? MSP_TELEMETRY_DELTA : MSP_TELEMETRY);
+            if (this->telemetryDelta)
+                serialize8(this->telemetrySequence++);
+            started = true;
+        }
+
+        if (!(this->telemetryDelta ? pushDeltaRecord(slot) : pushRecord(slot)))
+            continue;
+
+        slot->dueUsec += slot->periodMsec * 1000;
+        if ((int32_t)(now - slot->dueUsec) >= 0)
+            slot->dueUsec = now + slot->periodMsec * 1000;
+    }
+
+    if (!started)
+        return;
+
+    tailSerialReply();
+
+    this->telemetryReadyUsec = now + (uint32_t)(this->outCount - this->frameStart) * 1000000 / CONFIG_MSP_TELEMETRY_BYTES_PER_SEC;
+}
+
+// Hands the batched replies to the board; false leaves what it couldn't take for the next try
+bool MSP::flush(void)
+{
+    if (this->outCount == 0)
+        return true;
+
+    uint16_t sent = Board::serialWrite(this->outBuf, this->outCount);
+
+    this->outCount -= sent;
+    memmove(this->outBuf, &this->outBuf[sent], this->outCount);
+
+    return this->outCount == 0;
 }
 
 void MSP::init(class IMU * _imu, class Hover * _hover, 
-        class Mixer * _mixer, class RC * _rc, class Sonars * _sonars)
+        class Mixer * _mixer, class RC * _rc, class Sonars * _sonars, class Profiler * _profiler,
+        class Scheduler * _scheduler, class GainTable * _gains, class Autotune * _autotune, class Blackbox * _blackbox)
 {
     this->imu = _imu;
     this->hover = _hover;
     this->mixer = _mixer;
     this->rc = _rc;
     this->sonars = _sonars;
+    this->profiler = _profiler;
+    this->scheduler = _scheduler;
+    this->gains = _gains;
+    this->autotune = _autotune;
+    this->blackbox = _blackbox;
 
     memset(&this->portState, 0, sizeof(this->portState));
+    this->outCount = 0;
+    this->rxIndex = 0;
+    this->rxCount = 0;
+
+    memset(this->telemetry, 0, sizeof(this->telemetry));
+    this->telemetryReadyUsec = Board::getMicros();
+    this->telemetryDelta = false;
+    this->telemetrySequence = 0;
+    this->fieldCoding = false;
+    this->fieldRef = NULL;
 }
 
 void MSP::update(bool armed)
 {
-    while (Board::serialAvailableBytes()) {
+    // while the transmitter is still busy with earlier replies, requests wait in the receive buffer
+    if (!this->flush())
+        return;
 
-        uint8_t c = Board::serialReadByte();
+    uint32_t startTime = Board::getMicros();
+
+    for (uint16_t parsed = 0; parsed < CONFIG_MSP_RX_BYTES_PER_UPDATE; ++parsed) {
+
+        if (this->outCount + MAX_FRAME_SIZE > OUTBUF_SIZE)
+            break;
+
+        if (this->rxIndex == this->rxCount) {
+            if (Board::getMicros() - startTime > CONFIG_MSP_RX_USEC_PER_UPDATE)
+                break;
+            this->rxCount = Board::serialRead(this->rxBuf, RXBUF_SIZE);
+            this->rxIndex = 0;
+            if (this->rxCount == 0)
+                break;
+        }
+
+        uint8_t c = this->rxBuf[this->rxIndex++];
 
         if (portState.c_state == IDLE) {
             portState.c_state = (c == '$') ? HEADER_START : IDLE;
@@ -128,9 +525,33 @@ void MSP::update(bool armed)
                     Board::reboot();
             }
         } else if (portState.c_state == HEADER_START) {
-            portState.c_state = (c == 'M') ? HEADER_M : IDLE;
+            portState.c_state = (c == 'M') ? HEADER_M : (c == 'X') ? HEADER_X : IDLE;
         } else if (portState.c_state == HEADER_M) {
             portState.c_state = (c == '<') ? HEADER_ARROW : IDLE;
+            portState.version = 1;
+        } else if (portState.c_state == HEADER_X) {
+            portState.c_state = (c == '<') ? HEADER_V2 : IDLE;
+            portState.version = 2;
+            portState.offset = 0;
+            portState.checksum = 0;
+        } else if (portState.c_state == HEADER_V2) {
+            // flag, then command and size, little-endian
+            portState.checksum = checksum8(portState.version, portState.checksum, c);
+            switch (portState.offset++) {
+                case 1: portState.cmdMSP = c; break;
+                case 2: portState.cmdMSP |= c << 8; break;
+                case 3: portState.dataSize = c; break;
+                case 4: portState.dataSize |= c << 8; break;
+            }
+            if (portState.offset == 5) {
+                if (portState.dataSize > INBUF_SIZE) {
+                    portState.c_state = IDLE;
+                    continue;
+                }
+                portState.offset = 0;
+                portState.indRX = 0;
+                portState.c_state = HEADER_CMD;
+            }
         } else if (portState.c_state == HEADER_ARROW) {
             if (c > INBUF_SIZE) {       // now we are expecting the payload size
                 portState.c_state = IDLE;
@@ -148,7 +569,7 @@ void MSP::update(bool armed)
             portState.c_state = HEADER_CMD;
         } else if (portState.c_state == HEADER_CMD && 
                 portState.offset < portState.dataSize) {
-            portState.checksum ^= c;
+            portState.checksum = checksum8(portState.version, portState.checksum, c);
             portState.inBuf[portState.offset++] = c;
         } else if (portState.c_state == HEADER_CMD && portState.offset >= portState.dataSize) {
 
@@ -159,53 +580,90 @@ void MSP::update(bool armed)
                     case MSP_SET_RAW_RC:
                         for (uint8_t i = 0; i < 8; i++)
                             this->rc->data[i] = read16();
-                        headSerialReply(0);
+                        headSerialReply();
+                        break;
+
+                    case MSP_SET_MIXER:
+                        {
+                            // count, then all CONFIG_MAX_MOTORS rows of coefficients in thousandths; only while
+                            // disarmed, and only what the board can drive
+                            motorMixer_t rows[CONFIG_MAX_MOTORS];
+                            uint8_t count = read8();
+                            for (uint8_t i = 0; i < CONFIG_MAX_MOTORS; i++) {
+                                rows[i].throttle = (int16_t)read16() / 1000.f;
+                                rows[i].roll     = (int16_t)read16() / 1000.f;
+                                rows[i].pitch    = (int16_t)read16() / 1000.f;
+                                rows[i].yaw      = (int16_t)read16() / 1000.f;
+                            }
+                            if (!armed && portState.dataSize == 1 + 8*CONFIG_MAX_MOTORS && this->mixer->load(rows, count))
+                                headSerialReply();
+                            else
+                                headSerialError();
+                        }
                         break;
 
                     case MSP_SET_MOTOR:
-                        for (uint8_t i = 0; i < 4; i++)
-                            this->mixer->motorsDisarmed[i] = read16();
-                        headSerialReply(0);
+                        // one value for each motor of the loaded mixer
+                        if (portState.dataSize == 2*this->mixer->motorCount) {
+                            for (uint8_t i = 0; i < this->mixer->motorCount; i++)
+                                this->mixer->motorsDisarmed[i] = read16();
+                            headSerialReply();
+                        }
+                        else
+                            headSerialError();
                         break;
 
                     case MSP_SET_HEAD: 
                         this->hover->headHold = read16();
-                        headSerialReply(0);
+                        headSerialReply();
                         break;
 
-                    case MSP_RC:
-                        headSerialReply(16);
-                        for (uint8_t i = 0; i < 8; i++)
-                            serialize16(this->rc->data[i]);
+                    case MSP_SET_LOOP_TIMING:
+                        {
+                            uint8_t stage = read8();
+                            if (stage < PROFILE_STAGE_COUNT)
+                                this->profiler->histogramStage = stage;
+                            if (read8())
+                                this->profiler->reset();
+                        }
+                        headSerialReply();
                         break;
 
-                    case MSP_ATTITUDE:
-                        headSerialReply(6);
-                        for (uint8_t i = 0; i < 3; i++)
-                            serialize16(this->imu->angle[i]);
+                    case MSP_SET_GAIN_TABLE:
+                        {
+                            // the whole table or nothing, with its breakpoints ascending
+                            uint16_t voltageMillivolts[GAIN_VOLTAGE_POINTS];
+                            uint8_t  percent[GAIN_VOLTAGE_POINTS][GAIN_THROTTLE_POINTS][3];
+                            bool ok = portState.dataSize == 2*GAIN_VOLTAGE_POINTS + sizeof(percent);
+                            for (uint8_t v = 0; ok && v < GAIN_VOLTAGE_POINTS; v++) {
+                                voltageMillivolts[v] = read16();
+                                ok = v == 0 || voltageMillivolts[v-1] < voltageMillivolts[v];
+                            }
+                            for (uint8_t v = 0; ok && v < GAIN_VOLTAGE_POINTS; v++)
+                                for (uint8_t t = 0; t < GAIN_THROTTLE_POINTS; t++)
+                                    for (uint8_t k = 0; k < 3; k++)
+                                        percent[v][t][k] = read8();
+                            if (ok) {
+                                memcpy(this->gains->voltageMillivolts, voltageMillivolts, sizeof(voltageMillivolts));
+                                memcpy(this->gains->percent, percent, sizeof(percent));
+                                headSerialReply();
+                            }
+                            else
+                                headSerialError();
+                        }
                         break;
 
-                    case MSP_BARO_SONAR_RAW:
-                        //headSerialReply(8);
-                        //serialize32(baroPressure);
-                        //serialize32(sonarDistance);
+                    case MSP_SET_TELEMETRY:
+                        setTelemetry();
                         break;
 
-                    case MSP_ALTITUDE:
-                        headSerialReply(6);
-                        serialize32(this->hover->estAlt);
-                        serialize16(this->hover->vario);
-                        break;
-
-                    case MSP_SONARS:
-                        headSerialReply(8);
-                        for (uint8_t i = 0; i < 4; i++)
-                            serialize16(this->sonars->distances[i]);
-                        break;
-
-                    // don't know how to handle the (valid) message, indicate error MSP $M!
+                    // a request for data, or an unknown (valid) message, indicated by error MSP $M!
                     default:                   
-                        headSerialError(0);
+                        headSerialReply();
+                        if (!serializePayload(portState.cmdMSP)) {
+                            this->outCount = this->frameStart;
+                            headSerialError();
+                        }
                         break;
                 }
                 tailSerialReply();
@@ -213,6 +671,10 @@ void MSP::update(bool armed)
             portState.c_state = IDLE;
         }
     }
+
+    this->pushTelemetry();
+
+    this->flush();
 }
 
 #ifdef __arm__
@@ -19,11 +19,34 @@
 
 #define CONFIG_REBOOT_CHARACTER 'R'
 
+// Each update parses at most this much input and resumes where it stopped on the next one
+#define CONFIG_MSP_RX_BYTES_PER_UPDATE  64
+#define CONFIG_MSP_RX_USEC_PER_UPDATE   250
+
+// Subscribed telemetry is pushed without requests, sharing at most this much of the link
+// (half of a 57600-baud XBee) with replies
+#define CONFIG_MSP_TELEMETRY_SLOTS          8
+#define CONFIG_MSP_TELEMETRY_BYTES_PER_SEC  2880
+
+// Delta-coded telemetry keeps each slot's last payload if it fits here, and resends it in full
+// every so many pushes so a host that lost a frame can pick up again
+#define CONFIG_MSP_TELEMETRY_HISTORY_BYTES  16
+#define CONFIG_MSP_TELEMETRY_KEY_INTERVAL   50
+
 #ifdef __arm__
 extern "C" {
 #endif
 
-    static const int INBUF_SIZE = 128;
+    // MSPv2 frames carry a 16-bit size, but requests are still limited to what inBuf holds
+    static const int INBUF_SIZE = 256;
+
+    // Replies are batched here and handed to the board in non-blocking writes.  An MSPv2 frame
+    // is nine bytes around its payload, and no reply payload exceeds INBUF_SIZE.
+    static const int OUTBUF_SIZE = 512;
+    static const int MAX_FRAME_SIZE = 9 + INBUF_SIZE;
+
+    // received bytes fetched from the board but not yet parsed
+    static const int RXBUF_SIZE = 32;
 
     typedef enum serialState_t {
         IDLE,
@@ -31,16 +54,29 @@ extern "C" {
         HEADER_M,
         HEADER_ARROW,
         HEADER_SIZE,
-        HEADER_CMD
+        HEADER_CMD,
+        HEADER_X,
+        HEADER_V2       // flag, command and size of an MSPv2 frame
     } serialState_t;
 
+    // one subscribed message; zero period means the slot is empty
+    typedef struct telemetrySlot_t {
+        uint16_t cmdMSP;
+        uint16_t periodMsec;
+        uint32_t dueUsec;
+        uint8_t  size;                  // of the payload
+        uint8_t  untilKey;              // delta-coded pushes before the next full one
+        uint8_t  history[CONFIG_MSP_TELEMETRY_HISTORY_BYTES];
+    } telemetrySlot_t;
+
     typedef  struct mspPortState_t {
-        uint8_t checksum;
-        uint8_t indRX;
-        uint8_t inBuf[INBUF_SIZE];
-        uint8_t cmdMSP;
-        uint8_t offset;
-        uint8_t dataSize;
+        uint8_t  checksum;
+        uint16_t indRX;
+        uint8_t  inBuf[INBUF_SIZE];
+        uint16_t cmdMSP;
+        uint16_t offset;
+        uint16_t dataSize;
+        uint8_t  version;       // of the request, and so of its reply
         serialState_t c_state;
     } mspPortState_t;
 
@@ -53,24 +89,59 @@ extern "C" {
             class Mixer      * mixer;
             class RC         * rc;
             class Sonars     * sonars;
+            class Profiler   * profiler;
+            class Scheduler  * scheduler;
+            class GainTable  * gains;
+            class Autotune   * autotune;
+            class Blackbox   * blackbox;
 
             mspPortState_t portState;
 
+            uint8_t  outBuf[OUTBUF_SIZE];
+            uint16_t outCount;
+
+            uint16_t frameStart;    // of the frame being built in outBuf
+            uint8_t  frameVersion;
+
+            uint8_t  rxBuf[RXBUF_SIZE];
+            uint8_t  rxIndex;
+            uint8_t  rxCount;
+
+            telemetrySlot_t telemetry[CONFIG_MSP_TELEMETRY_SLOTS];
+            uint32_t telemetryReadyUsec;    // when the bandwidth budget allows the next push
+            bool     telemetryDelta;        // push TELEMETRY_DELTA rather than TELEMETRY frames
+            uint8_t  telemetrySequence;
+
+            // while coding, payload fields go out as zigzag varints of their change since fieldRef,
+            // which is updated as they go; a NULL fieldRef codes against zero
+            bool     fieldCoding;
+            uint8_t * fieldRef;
+
+            void put8(uint8_t a);
+            void putVarint(uint32_t a);
+            void serializeField(uint32_t a, uint8_t width);
             void serialize8(uint8_t a);
             void serialize16(int16_t a);
             uint8_t read8(void);
             uint16_t read16(void);
             uint32_t read32(void);
             void serialize32(uint32_t a);
-            void headSerialResponse(uint8_t err, uint8_t s);
-            void headSerialReply(uint8_t s);
-            void headSerialError(uint8_t s);
+            void headFrame(uint8_t version, uint8_t type, uint16_t cmd);
+            void headSerialReply(void);
+            void headSerialError(void);
             void tailSerialReply(void);
+            bool serializePayload(uint16_t cmd);
+            void setTelemetry(void);
+            void pushTelemetry(void);
+            bool pushRecord(telemetrySlot_t * slot);
+            bool pushDeltaRecord(telemetrySlot_t * slot);
+            bool flush(void);
 
         public:
 
             void init(class IMU * _imu, class Hover * _hover, class Mixer * _mixer, 
-                    class RC * _rc, class Sonars * _sonars);
+                    class RC * _rc, class Sonars * _sonars, class Profiler * _profiler, class Scheduler * _scheduler,
+                    class GainTable * _gains, class Autotune * _autotune, class Blackbox * _blackbox);
 
             void update(bool armed);
 
@@ -0,0 +1,161 @@
+/*
+   pidcontroller.cpp : Floating-point PID controller class implementation
+
+   Works in degrees and degrees/sec, as a cascade.  The outer angle loop turns
+   the sticks into a rate setpoint, blended toward a self-leveling rate demand
+   near center stick as in baseflight's horizon mode.  The inner rate loop can
+   run CONFIG_RATE_LOOP_MULTIPLE times per outer update; its output is feed-forward on the setpoint plus
+   PI on the rate error and D on the low-passed measured rate, so stick moves
+   don't kick the D-term.  The integral only accumulates while the output is
+   within limits or the error would bring it back (conditional integration).
+
+   Gains are converted from the per-target integer pidvals.hpp, so a vehicle
+   tuned for Stabilize flies the same on this controller.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+#include "pidvals.hpp"
+
+void PidController::init(class RC * _rc, class IMU * _imu, class GainTable * _gains, uint32_t looptimeUsec)
+{
+    this->rc = _rc;
+    this->imu = _imu;
+    this->gains = _gains;
+
+    float angleLooptimeSec = looptimeUsec * 1e-6f;
+
+#if CASCADED_RATE_LOOP
+    this->looptimeSec = angleLooptimeSec / CONFIG_RATE_LOOP_MULTIPLE;
+#else
+    this->looptimeSec = angleLooptimeSec;
+#endif
+
+    // Stabilize works in gyro counts / 4 per IMU loop: convert its gains to per-second units
+    float countsPerDps = 1 / (this->imu->gyroDegreesPerSecondPerCount() * 4);
+
+    uint8_t p[3] = {CONFIG_RATE_PITCHROLL_P, CONFIG_RATE_PITCHROLL_P, CONFIG_YAW_P};
+    uint8_t i[3] = {CONFIG_RATE_PITCHROLL_I, CONFIG_RATE_PITCHROLL_I, CONFIG_YAW_I};
+    uint8_t d[3] = {CONFIG_RATE_PITCHROLL_D, CONFIG_RATE_PITCHROLL_D, 0};
+
+    for (uint8_t axis=0; axis<3; ++axis) {
+        this->rateP[axis] = countsPerDps * p[axis] / 80;
+        this->rateI[axis] = countsPerDps * i[axis] / 8000 / angleLooptimeSec;
+        this->rateD[axis] = countsPerDps * d[axis] * 3 / 32 * angleLooptimeSec;
+    }
+
+    // motor units per degree of tilt, divided by the rate P they act through
+    this->levelP = CONFIG_LEVEL_P * 10 / 100.0f / this->rateP[AXIS_ROLL];
+
+    float tau = 1 / (2 * M_PI * CONFIG_DTERM_LPF_HZ);
+    this->derivativeAlpha = this->looptimeSec / (tau + this->looptimeSec);
+
+    for (uint8_t axis=0; axis<3; ++axis) {
+        this->rateSetpoint[axis] = 0;
+        this->lastRate[axis] = 0;
+        this->derivative[axis] = 0;
+    }
+
+    this->resetIntegral();
+}
+
+void PidController::update(void)
+{
+    this->updateAngle();
+    this->updateRate();
+}
+
+void PidController::updateAngle(void)
+{
+    // stick deflection in [0,1]: full deflection is pure rate mode
+    float prop = max(abs(this->rc->command[DEMAND_PITCH]), abs(this->rc->command[DEMAND_ROLL])) / 500.0f;
+
+    for (uint8_t axis = 0; axis < 3; axis++) {
+
+        // stick rate, scaled as in Stabilize so that full stick is the same rate
+        float setpoint = this->rc->command[axis] / this->rateP[axis];
+
+        if (axis < 2) {
+            int32_t angleDemand = constrain(2 * this->rc->command[axis], 
+                    -((int)CONFIG_MAX_ANGLE_INCLINATION), + CONFIG_MAX_ANGLE_INCLINATION);
+            float levelRate = this->levelP * (angleDemand - this->imu->angle[axis]) / 10;
+            setpoint = levelRate * (1 - prop) + setpoint * prop;
+        }
+
+        this->rateSetpoint[axis] = setpoint;
+    }
+}
+
+void PidController::updateRate(void)
+{
+    // scheduled gains act on the feedback terms; feed-forward and stick rates stay fixed
+    uint16_t scale[3];
+    this->gains->lookup(this->rc->command[DEMAND_THROTTLE], scale);
+
+    float kP = scale[GAIN_P] / 256.0f;
+    float kI = scale[GAIN_I] / 256.0f;
+    float kD = scale[GAIN_D] / 256.0f;
+
+    for (uint8_t axis = 0; axis < 3; axis++) {
+
+        float setpoint = this->rateSetpoint[axis];
+        float rate = this->imu->gyroDegreesPerSecond(axis);
+        float error = setpoint - rate;
+
+        // derivative on measurement, first-order low-passed
+        float change = (rate - this->lastRate[axis]) / this->looptimeSec;
+        this->lastRate[axis] = rate;
+        this->derivative[axis] += this->derivativeAlpha * (change - this->derivative[axis]);
+
+        float FTerm = CONFIG_PID_FEEDFORWARD * this->rateP[axis] * setpoint;
+        float PTerm = kP * this->rateP[axis] * error;
+        float DTerm = kD * this->rateD[axis] * this->derivative[axis];
+
+        float output = FTerm + PTerm + this->integral[axis] - DTerm;
+
+        // conditional integration: hold the integral while saturated, unless the error would unwind it
+        bool saturated = fabsf(output) >= CONFIG_PID_OUTPUT_LIMIT;
+        if (!saturated || (error > 0) != (output > 0)) {
+            this->integral[axis] += kI * this->rateI[axis] * error * this->looptimeSec;
+            this->integral[axis] = constrain(this->integral[axis], -CONFIG_PID_ITERM_LIMIT, +CONFIG_PID_ITERM_LIMIT);
+        }
+
+        output = FTerm + PTerm + this->integral[axis] - DTerm;
+
+        this->axisP[axis] = (int16_t)lrintf(FTerm + PTerm);
+        this->axisI[axis] = (int16_t)lrintf(this->integral[axis]);
+        this->axisD[axis] = (int16_t)lrintf(-DTerm);
+
+        this->axisPID[axis] = (int16_t)lrintf(constrain(output, -CONFIG_PID_OUTPUT_LIMIT, +CONFIG_PID_OUTPUT_LIMIT));
+    }
+
+    // prevent "yaw jump" during yaw correction
+    this->axisPID[AXIS_YAW] = constrain(this->axisPID[AXIS_YAW], 
+            -100 - abs(this->rc->command[DEMAND_YAW]), +100 + abs(this->rc->command[DEMAND_YAW]));
+}
+
+void PidController::resetIntegral(void)
+{
+    for (uint8_t axis=0; axis<3; ++axis)
+        this->integral[axis] = 0;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
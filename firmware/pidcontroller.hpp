@@ -0,0 +1,99 @@
+/*
+   pidcontroller.hpp : Floating-point PID controller class header
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Attitude controller: baseflight's integer Stabilize, or the floating-point PidController.
+// Boards built without an FPU keep the integer controller.
+#define PID_CONTROLLER_BASEFLIGHT   0
+#define PID_CONTROLLER_FLOAT        1
+
+#ifdef FIXED_POINT
+#define CONFIG_PID_CONTROLLER       PID_CONTROLLER_BASEFLIGHT
+#else
+#define CONFIG_PID_CONTROLLER       PID_CONTROLLER_FLOAT
+#endif
+
+// The inner rate loop runs this many times per attitude update, on the newest gyro from the ring
+#define CONFIG_RATE_LOOP_MULTIPLE   3
+
+#define CASCADED_RATE_LOOP          (CONFIG_PID_CONTROLLER == PID_CONTROLLER_FLOAT && CONFIG_RATE_LOOP_MULTIPLE > 1 && \
+                                     CONFIG_IMU_RING)
+
+#define CONFIG_PID_FEEDFORWARD      0.3f    // setpoint feed-forward, as a fraction of rate P
+#define CONFIG_PID_OUTPUT_LIMIT     500     // integration stops while the output is pushed past this
+#define CONFIG_PID_ITERM_LIMIT      250
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    class PidController {
+
+        private:
+
+            class RC  * rc;
+            class IMU * imu;
+            class GainTable * gains;
+
+            float   looptimeSec;        // of the rate loop
+            float   rateSetpoint[3];    // degrees/sec, from the angle loop
+
+            // gains in motor units per degree/sec (P, FF), per degree (I), per degree/sec^2 (D);
+            // levelP is degrees/sec of rate demand per degree of attitude error
+            float   rateP[3];
+            float   rateI[3];
+            float   rateD[3];
+            float   levelP;
+
+            float   integral[3];
+            float   lastRate[3];
+            float   derivative[3];      // low-passed rate of change of measured rate
+            float   derivativeAlpha;
+
+        public:
+
+            int16_t axisPID[3];
+
+            // terms of axisPID before limiting, for the blackbox; P includes feed-forward
+            int16_t axisP[3];
+            int16_t axisI[3];
+            int16_t axisD[3];
+
+            void init(class RC * _rc, class IMU * _imu, class GainTable * _gains, uint32_t looptimeUsec);
+
+            // outer loop: sticks and attitude to rate setpoints
+            void updateAngle(void);
+
+            // inner loop: rate setpoints and gyro to axisPID
+            void updateRate(void);
+
+            // both loops, at the same rate
+            void update(void);
+
+            void resetIntegral(void);
+    };
+
+#if CONFIG_PID_CONTROLLER == PID_CONTROLLER_FLOAT
+    typedef PidController Controller;
+#else
+    typedef Stabilize Controller;
+#endif
+
+#ifdef __arm__
+} // extern "C"
+#endif
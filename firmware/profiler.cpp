@@ -0,0 +1,121 @@
+/*
+   profiler.cpp : Loop-timing profiler class implementation
+
+   Keeps min/max/mean and a log2 histogram of execution time for each stage of
+   the IMU task and for MSP, plus the jitter of the IMU period itself.
+   Stage times come from Board::getTicks(), which is a CPU cycle counter on
+   boards that have one and the microsecond clock otherwise.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+#include <string.h>
+
+void Profiler::init(uint32_t _imuLooptimeUsec)
+{
+    this->imuLooptimeUsec = _imuLooptimeUsec;
+    this->ticksPerUsec = Board::getTicksPerMicrosecond();
+    this->histogramStage = PROFILE_LOOP;
+
+    this->reset();
+}
+
+void Profiler::reset(void)
+{
+    memset(this->stages, 0, sizeof(this->stages));
+    memset(this->startTicks, 0, sizeof(this->startTicks));
+    this->previousImuMicros = 0;
+}
+
+void Profiler::record(uint8_t stage, uint32_t ticks)
+{
+    profileStage_t * s = &this->stages[stage];
+
+    if (s->count == 0 || ticks < s->minTicks)
+        s->minTicks = ticks;
+    if (ticks > s->maxTicks)
+        s->maxTicks = ticks;
+    s->sumTicks += ticks;
+    s->count++;
+
+    uint32_t usec = ticks / this->ticksPerUsec;
+    uint8_t bucket = 0;
+    while (usec > 1 && bucket < PROFILE_BUCKET_COUNT-1) {
+        usec >>= 1;
+        bucket++;
+    }
+    s->histogram[bucket]++;
+}
+
+void Profiler::start(uint8_t stage)
+{
+    this->startTicks[stage] = Board::getTicks();
+}
+
+void Profiler::stop(uint8_t stage)
+{
+    this->record(stage, Board::getTicks() - this->startTicks[stage]);
+}
+
+void Profiler::imuPeriod(uint32_t currentMicros)
+{
+    // no period to measure on the first IMU update after a reset
+    if (this->previousImuMicros) {
+        int32_t jitter = (int32_t)(currentMicros - this->previousImuMicros - this->imuLooptimeUsec);
+        this->record(PROFILE_PERIOD, abs(jitter) * this->ticksPerUsec);
+    }
+
+    this->previousImuMicros = currentMicros;
+}
+
+// Tenths of a microsecond below 3276.8 usec; above that, whole microseconds with the top bit
+// set, up to 32767 usec
+static uint16_t ticksToTiming(uint64_t ticks, uint32_t ticksPerUsec)
+{
+    uint64_t tenths = ticks * 10 / ticksPerUsec;
+
+    if (tenths < PROFILE_TIMING_USEC)
+        return (uint16_t)tenths;
+
+    uint64_t usec = ticks / ticksPerUsec;
+
+    return PROFILE_TIMING_USEC | (usec < PROFILE_TIMING_USEC ? (uint16_t)usec : PROFILE_TIMING_USEC - 1);
+}
+
+uint16_t Profiler::getMin(uint8_t stage)
+{
+    return ticksToTiming(this->stages[stage].minTicks, this->ticksPerUsec);
+}
+
+uint16_t Profiler::getMax(uint8_t stage)
+{
+    return ticksToTiming(this->stages[stage].maxTicks, this->ticksPerUsec);
+}
+
+uint16_t Profiler::getMean(uint8_t stage)
+{
+    profileStage_t * s = &this->stages[stage];
+
+    return s->count ? ticksToTiming(s->sumTicks / s->count, this->ticksPerUsec) : 0;
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
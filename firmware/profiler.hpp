@@ -0,0 +1,88 @@
+/*
+   profiler.hpp : Loop-timing profiler class header
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Stages we time; PROFILE_PERIOD holds IMU-period jitter rather than an execution time
+enum {
+    PROFILE_IMU = 0,
+    PROFILE_EXPO,
+    PROFILE_MSP,
+    PROFILE_HOVER,
+    PROFILE_STABILIZE,
+    PROFILE_MIXER,
+    PROFILE_BLACKBOX,
+    PROFILE_LOOP,
+    PROFILE_PERIOD,
+    PROFILE_STAGE_COUNT
+};
+
+// Histogram bucket k counts samples in [2^k, 2^(k+1)) microseconds; bucket 0 also counts zero
+#define PROFILE_BUCKET_COUNT 12
+
+// Set in an MSP timing value that is in whole microseconds rather than tenths
+#define PROFILE_TIMING_USEC  0x8000
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    typedef struct profileStage_t {
+        uint32_t minTicks;
+        uint32_t maxTicks;
+        uint64_t sumTicks;
+        uint32_t count;
+        uint32_t histogram[PROFILE_BUCKET_COUNT];
+    } profileStage_t;
+
+    class Profiler {
+
+        private:
+
+            uint32_t ticksPerUsec;
+            uint32_t startTicks[PROFILE_STAGE_COUNT];
+            uint32_t previousImuMicros;
+            uint32_t imuLooptimeUsec;
+
+            void record(uint8_t stage, uint32_t ticks);
+
+        public:
+
+            profileStage_t stages[PROFILE_STAGE_COUNT];
+
+            // selected by MSP for histogram reporting
+            uint8_t histogramStage;
+
+            void init(uint32_t _imuLooptimeUsec);
+
+            void reset(void);
+
+            void start(uint8_t stage);
+
+            void stop(uint8_t stage);
+
+            void imuPeriod(uint32_t currentMicros);
+
+            // summary values for MSP, in tenths of a microsecond or, with PROFILE_TIMING_USEC set, whole ones
+            uint16_t getMin(uint8_t stage);
+            uint16_t getMax(uint8_t stage);
+            uint16_t getMean(uint8_t stage);
+    };
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -0,0 +1,131 @@
+/*
+   scheduler.cpp : Rate-monotonic task scheduler class implementation
+
+   Tasks are declared with a period and a worst-case execution budget, and are
+   numbered in priority order.  Each call to run() executes the due tasks from
+   highest priority down, but starts a task below TASK_IMU only if its budget fits
+   in the time remaining before the next rate-loop or IMU release; otherwise it
+   and everything below it are deferred to a later call.  Tasks are never preempted, so a task
+   that finishes more than one period after its release has missed its deadline.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+#include "hackflight.hpp"
+
+#include <string.h>
+
+void Scheduler::init(void)
+{
+    memset(this->tasks, 0, sizeof(this->tasks));
+}
+
+void Scheduler::add(uint8_t id, taskFunction_t function, uint32_t periodUsec, uint32_t budgetUsec)
+{
+    task_t * task = &this->tasks[id];
+
+    task->function = function;
+    task->periodUsec = periodUsec;
+    task->budgetUsec = budgetUsec;
+    task->releaseUsec = Board::getMicros();
+    task->enabled = true;
+}
+
+void Scheduler::enable(uint8_t id, bool enabled)
+{
+    this->tasks[id].enabled = enabled;
+}
+
+void Scheduler::trigger(uint8_t id)
+{
+    this->tasks[id].triggered = true;
+}
+
+void Scheduler::execute(uint8_t id, uint32_t currentTime)
+{
+    task_t * task = &this->tasks[id];
+
+    bool periodic = (int32_t)(currentTime - task->releaseUsec) >= 0;
+
+    task->triggered = false;
+
+    task->function(currentTime);
+
+    uint32_t endTime = Board::getMicros();
+
+    uint32_t elapsed = endTime - currentTime;
+    if (elapsed > task->maxUsec)
+        task->maxUsec = elapsed;
+
+    // a triggered run between releases doesn't count against the schedule
+    if (!periodic)
+        return;
+
+    if (endTime - task->releaseUsec > task->periodUsec)
+        task->deadlineMisses++;
+
+    // next release is one period on, unless we have fallen a whole period behind
+    task->deferredRelease = false;
+    task->releaseUsec += task->periodUsec;
+    if ((int32_t)(endTime - task->releaseUsec) >= 0)
+        task->releaseUsec = endTime + task->periodUsec;
+}
+
+void Scheduler::run(void)
+{
+    for (uint8_t id=0; id<TASK_COUNT; ++id) {
+
+        task_t * task = &this->tasks[id];
+
+        if (!task->enabled)
+            continue;
+
+        uint32_t currentTime = Board::getMicros();
+
+        if (!task->triggered && (int32_t)(currentTime - task->releaseUsec) < 0)
+            continue;
+
+        // the gyro, rate and IMU frames always run; anything else must finish before the next of them
+        if (id > TASK_IMU) {
+
+            int32_t slack = 0x7FFFFFFF;
+            for (uint8_t k=0; k<=TASK_IMU; ++k)
+                if (this->tasks[k].enabled)
+                    slack = min(slack, (int32_t)(this->tasks[k].releaseUsec - currentTime));
+
+            if (slack < (int32_t)task->budgetUsec) {
+                // once per release, however many passes it waits
+                for (uint8_t k=id; k<TASK_COUNT; ++k) {
+                    task_t * waiting = &this->tasks[k];
+                    if (waiting->enabled && !waiting->deferredRelease &&
+                            (int32_t)(currentTime - waiting->releaseUsec) >= 0) {
+                        waiting->deferrals++;
+                        waiting->deferredRelease = true;
+                    }
+                }
+                return;
+            }
+        }
+
+        this->execute(id, currentTime);
+    }
+}
+
+#ifdef __arm__
+} // extern "C"
+#endif
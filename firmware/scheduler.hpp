@@ -0,0 +1,78 @@
+/*
+   scheduler.hpp : Rate-monotonic task scheduler class header
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Tasks in priority order: highest first.  TASK_GYRO, TASK_RATE and TASK_IMU always run
+// when due; every task below them must fit into the time before their next release.
+enum {
+    TASK_GYRO = 0,
+    TASK_RATE,
+    TASK_IMU,
+    TASK_RC,
+    TASK_ALTITUDE,
+    TASK_SONARS,
+    TASK_MSP,
+    TASK_DYN_NOTCH,
+    TASK_BLACKBOX,
+    TASK_COUNT
+};
+
+#ifdef __arm__
+extern "C" {
+#endif
+
+    typedef void (*taskFunction_t)(uint32_t currentTime);
+
+    typedef struct task_t {
+        taskFunction_t function;
+        uint32_t periodUsec;
+        uint32_t budgetUsec;
+        uint32_t releaseUsec;       // start of current period
+        bool     enabled;
+        bool     triggered;         // run at next opportunity, outside the periodic schedule
+        uint32_t maxUsec;           // worst observed execution time
+        uint32_t deadlineMisses;    // completed more than one period after release
+        uint32_t deferrals;         // releases held back because they would not have fit before the next gyro, rate or IMU frame
+        bool     deferredRelease;   // current release already counted in deferrals
+    } task_t;
+
+    class Scheduler {
+
+        private:
+
+            void execute(uint8_t id, uint32_t currentTime);
+
+        public:
+
+            task_t tasks[TASK_COUNT];
+
+            void init(void);
+
+            void add(uint8_t id, taskFunction_t function, uint32_t periodUsec, uint32_t budgetUsec);
+
+            void enable(uint8_t id, bool enabled);
+
+            void trigger(uint8_t id);
+
+            void run(void);
+
+    }; // class Scheduler
+
+#ifdef __arm__
+} // extern "C"
+#endif
@@ -30,15 +30,15 @@ extern "C" {
 #include "hackflight.hpp"
 #include "pidvals.hpp"
 
-void Stabilize::init(class RC * _rc, class IMU * _imu)
+void Stabilize::init(class RC * _rc, class IMU * _imu, class GainTable * _gains, uint32_t looptimeUsec)
 {
     this->rc = _rc;
     this->imu = _imu;
+    this->gains = _gains;
 
     for (uint8_t axis=0; axis<3; ++axis) {
         this->lastGyroError[axis] = 0;
-        this->delta1[axis] = 0;
-        this->delta2[axis] = 0;
+        biquadInitLowpass(&this->dtermLpf[axis], CONFIG_DTERM_LPF_HZ, 1e6f / looptimeUsec);
     }
 
     this->rate_p[0] = CONFIG_RATE_PITCHROLL_P;
@@ -58,6 +58,10 @@ void Stabilize::init(class RC * _rc, class IMU * _imu)
 
 void Stabilize::update(void)
 {
+    // scheduled gains act on the feedback terms; stick-to-rate scaling stays fixed
+    uint16_t scale[3];
+    this->gains->lookup(this->rc->command[DEMAND_THROTTLE], scale);
+
     for (uint8_t axis = 0; axis < 3; axis++) {
 
         int32_t gyroError = this->imu->gyroADC[axis] / 4;
@@ -69,7 +73,7 @@ void Stabilize::update(void)
         this->errorGyroI[axis] = constrain(this->errorGyroI[axis] + error, -16000, +16000); // WindUp
         if ((abs(gyroError) > 640) || ((axis == AXIS_YAW) && (abs(this->rc->command[axis]) > 100)))
             this->errorGyroI[axis] = 0;
-        int32_t ITermGYRO = (this->errorGyroI[axis] / 125 * this->rate_i[axis]) >> 6;
+        int32_t ITermGYRO = (this->errorGyroI[axis] / 125 * (this->rate_i[axis] * scale[GAIN_I] >> 8)) >> 6;
 
         int32_t PTerm = PTermGYRO;
         int32_t ITerm = ITermGYRO;
@@ -94,13 +98,15 @@ void Stabilize::update(void)
             ITerm = (ITermACC * (500 - prop) + ITermGYRO * prop) / 500;
         } 
 
-        PTerm -= gyroError * this->rate_p[axis] / 10 / 8; // 32 bits is needed for calculation
+        PTerm -= gyroError * (this->rate_p[axis] * scale[GAIN_P] >> 8) / 10 / 8; // 32 bits is needed for calculation
         int32_t delta = gyroError - this->lastGyroError[axis];
         this->lastGyroError[axis] = gyroError;
-        int32_t deltaSum = this->delta1[axis] + this->delta2[axis] + delta;
-        this->delta2[axis] = this->delta1[axis];
-        this->delta1[axis] = delta;
-        int32_t DTerm = (deltaSum * this->rate_d[axis]) / 32;
+        // gain of three matches the DC gain of the old three-sample sum, so rate_d tunes the same
+        filterSample_t dterm = biquadApply(&this->dtermLpf[axis], FILTER_SAMPLE(3 * delta * (this->rate_d[axis] * scale[GAIN_D] >> 8)));
+        int32_t DTerm = FILTER_TO_INT(dterm) / 32;
+        this->axisP[axis] = PTerm;
+        this->axisI[axis] = ITerm;
+        this->axisD[axis] = -DTerm;
         this->axisPID[axis] = PTerm + ITerm - DTerm;
     }
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #define CONFIG_MAX_ANGLE_INCLINATION                500 /* 50 degrees */
+#define CONFIG_DTERM_LPF_HZ                         40  /* replaces the three-sample sum */
 
 #ifdef __arm__
 extern "C" {
@@ -29,14 +30,14 @@ extern "C" {
 
             class RC  * rc;
             class IMU * imu;
+            class GainTable * gains;
 
             uint8_t rate_p[3];
             uint8_t rate_i[3];
             uint8_t rate_d[3];
 
             int16_t lastGyroError[3];
-            int32_t delta1[3]; 
-            int32_t delta2[3];
+            biquad_t dtermLpf[3];
             int32_t errorGyroI[3];
             int32_t errorAngleI[2];
 
@@ -44,7 +45,12 @@ extern "C" {
 
             int16_t axisPID[3];
 
-            void init(class RC * _rc, class IMU * _imu);
+            // terms of axisPID before limiting, for the blackbox
+            int16_t axisP[3];
+            int16_t axisI[3];
+            int16_t axisD[3];
+
+            void init(class RC * _rc, class IMU * _imu, class GainTable * _gains, uint32_t looptimeUsec);
 
             void update(void);
 
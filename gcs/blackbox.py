@@ -0,0 +1,203 @@
+#!/usr/bin/env python
+
+'''
+blackbox.py : decodes Hackflight blackbox logs to CSV
+
+Usage: blackbox.py LOGFILE
+
+Writes LOGFILE.01.csv, LOGFILE.02.csv, ... one for each time the vehicle was armed.
+Everything needed to decode the frames comes from the header lines at the start of each log.
+
+Copyright (C) Simon D. Levy 2016
+
+This file is part of Hackflight.
+
+Hackflight is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+This code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this code.  If not, see <http:#www.gnu.org/licenses/>.
+'''
+
+import sys
+
+# Predictors and encodings, numbered as in firmware/blackboxencoder.hpp
+PREDICT_ZERO          = 0
+PREDICT_PREVIOUS      = 1
+PREDICT_STRAIGHT_LINE = 2
+PREDICT_AVERAGE_2     = 3
+PREDICT_FIELD_0       = 4
+PREDICT_MIN_PWM       = 5
+
+ENCODE_SIGNED_VARINT   = 0
+ENCODE_UNSIGNED_VARINT = 1
+
+MIN_PWM = 1000
+
+def _u32(value):
+    return value & 0xFFFFFFFF
+
+def _s32(value):
+    value = _u32(value)
+    return value - (1 << 32) if value & 0x80000000 else value
+
+class Log(object):
+
+    def __init__(self):
+
+        self.header = {}
+        self.rows = []
+        self.intra = 0
+        self.missing = 0
+
+        self.previous = None
+        self.beforePrevious = None
+
+    def addHeader(self, line):
+
+        key, value = line[2:].split(':', 1)
+        self.header[key] = value
+
+        if key == 'Field names':
+            self.names = value.split(',')
+            # the first field of a group is the one that others can be predicted from
+            self.groups = []
+            for k,name in enumerate(self.names):
+                prefix = name.split('[')[0]
+                same = k > 0 and '[' in name and self.names[k-1].split('[')[0] == prefix
+                self.groups.append(self.groups[k-1] if same else k)
+
+    def _list(self, key):
+
+        return [int(value) for value in self.header[key].split(',')]
+
+    def decodeFrame(self, data, pos, intra):
+
+        if self.previous is None:
+            self.signed = self._list('Field signed')
+            self.intraPredictors = self._list('Field I predictor')
+            self.intraEncodings = self._list('Field I encoding')
+            self.interPredictors = self._list('Field P predictor')
+            self.divisor = int(self.header.get('Divisor', 1))
+
+        # an inter frame can't be decoded without the frames before it
+        if not intra and self.previous is None:
+            raise ValueError('inter frame before any intra frame')
+
+        values = []
+
+        for k in range(len(self.names)):
+
+            raw, pos = _varint(data, pos)
+
+            if intra and self.intraEncodings[k] == ENCODE_UNSIGNED_VARINT:
+                residual = raw
+            else:
+                residual = (raw >> 1) ^ -(raw & 1)
+
+            predictor = self.intraPredictors[k] if intra else self.interPredictors[k]
+
+            if predictor == PREDICT_PREVIOUS:
+                prediction = self.previous[k]
+            elif predictor == PREDICT_STRAIGHT_LINE:
+                prediction = 2 * self.previous[k] - self.beforePrevious[k]
+            elif predictor == PREDICT_AVERAGE_2:
+                # rounds toward zero, like C
+                total = _s32(self.previous[k]) + _s32(self.beforePrevious[k])
+                prediction = abs(total) // 2 * (1 if total >= 0 else -1)
+            elif predictor == PREDICT_FIELD_0:
+                prediction = values[self.groups[k]]
+            elif predictor == PREDICT_MIN_PWM:
+                prediction = MIN_PWM
+            else:
+                prediction = 0
+
+            values.append(_u32(prediction + residual))
+
+        if self.rows:
+            self.missing += _u32(values[0] - self.previous[0]) // self.divisor - 1
+
+        self.beforePrevious = values if intra else self.previous
+        self.previous = values
+
+        self.rows.append([_s32(value) if signed else value for value,signed in zip(values, self.signed)])
+        self.intra += intra
+
+        return pos
+
+def _varint(data, pos):
+
+    value = 0
+    shift = 0
+
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+def decode(data):
+    '''
+    Returns a Log for each time the vehicle was armed
+    '''
+
+    logs = []
+    pos = 0
+    log = None
+
+    while pos < len(data):
+
+        marker = chr(data[pos])
+
+        if marker == 'H':
+            end = data.find(b'\n', pos)
+            if end < 0:
+                break
+            line = data[pos:end].decode()
+            if line.startswith('H Product:'):
+                log = Log()
+                logs.append(log)
+            log.addHeader(line)
+            pos = end + 1
+
+        elif marker in 'IP' and log is not None:
+            try:
+                pos = log.decodeFrame(data, pos+1, marker == 'I')
+            except IndexError:
+                # a frame cut off by the end of the flash
+                break
+
+        elif marker == 'E':
+            log = None
+            pos += 1
+
+        else:
+            raise ValueError('bad frame at byte %d' % pos)
+
+    return logs
+
+if __name__ == '__main__':
+
+    if len(sys.argv) != 2:
+        print('Usage: %s LOGFILE' % sys.argv[0])
+        sys.exit(1)
+
+    filename = sys.argv[1]
+
+    logs = decode(bytearray(open(filename, 'rb').read()))
+
+    for k,log in enumerate(logs):
+        csvname = '%s.%02d.csv' % (filename, k+1)
+        with open(csvname, 'w') as csv:
+            csv.write(','.join(log.names) + '\n')
+            for row in log.rows:
+                csv.write(','.join(str(value) for value in row) + '\n')
+        print('%s: %d frames (%d intra), %d missing' % (csvname, len(log.rows), log.intra, log.missing))
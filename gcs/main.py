@@ -31,6 +31,11 @@ CONNECTION_DELAY_MSEC = 1000 #4000
 
 USB_UPDATE_MSEC = 200
 
+# Message ids and periods the flight controller streams to us once subscribed
+TELEMETRY_SUBSCRIPTIONS = ((108, 20),  # ATTITUDE
+                           (105, 50))  # RC
+TELEMETRY_SLOTS = 8
+
 from serial import Serial
 from serial.tools.list_ports import comports
 from threading import Thread
@@ -122,10 +127,6 @@ class GCS:
         # Create a message parser 
         self.parser = MSP_Parser()
 
-        # Set up parser's request strings
-        self.attitude_request = serialize_ATTITUDE_Request()
-        self.rc_request = serialize_RC_Request()
-
         # No messages yet
         self.yaw_pitch_roll = 0,0,0
         self.rxchannels = 0,0,0,0,0
@@ -205,21 +206,19 @@ class GCS:
     def _start(self):
 
         self.parser.set_ATTITUDE_Handler(self._handle_attitude)
-        self._send_attitude_request()
         self.setup.start()
 
         self.parser.set_RC_Handler(self._handle_rc)
-        self._send_rc_request()
-
-    # Sends Attitude request to FC
-    def _send_attitude_request(self):
 
-        self.comms.send_request(self.attitude_request)
+        self._subscribe(TELEMETRY_SUBSCRIPTIONS)
 
-    # Sends RC request to FC
-    def _send_rc_request(self):
+    # Asks the FC to push these messages from now on, delta-coded, instead of our polling for them
+    def _subscribe(self, subscriptions):
 
-        self.comms.send_request(self.rc_request)
+        slots = [0] * (2*TELEMETRY_SLOTS)
+        for k,(msgid,period) in enumerate(subscriptions):
+            slots[2*k:2*k+2] = msgid, period
+        self.comms.send_request(serialize_SET_TELEMETRY(*(slots + [1])))
 
     # Callback for Motors button
     def _motors_button_callback(self):
@@ -292,6 +291,7 @@ class GCS:
 
             if not self.comms is None:
 
+                self._subscribe(())
                 self.comms.stop()
 
             self._clear()
@@ -439,16 +439,10 @@ class GCS:
 
         self.messages.setCurrentMessage('Yaw/Pitch/Roll: %+3.3f %+3.3f %+3.3f' % self.yaw_pitch_roll)
 
-        # As soon as we handle the callback from one request, send another request
-        self._send_attitude_request()
-
     def _handle_rc(self, c1, c2, c3, c4, c5, c6, c7, c8):
 
         self.rxchannels = c1, c2, c3, c4, c5
 
-        # As soon as we handle the callback from one request, send another request
-        self._send_rc_request()
-
         self.messages.setCurrentMessage('Receiver: %04d %04d %04d %04d %04d' % (c1, c2, c3, c4, c5))
 
     def _handle_arm_status(self, armed):
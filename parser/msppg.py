@@ -47,7 +47,9 @@ def _openw(fname):
 
 class CodeEmitter(object):
 
-    def __init__(self, folder, ext):
+    def __init__(self, folder, ext, v2):
+
+        self.v2 = v2
 
         mkdir_if_missing('output/%s' % folder)
         self._copyfile('%s.makefile' % folder, '%s/Makefile' % folder)
@@ -86,6 +88,46 @@ class CodeEmitter(object):
 
         return self._paysize(argtypes)
 
+    def _isv2(self, msgid, argtypes):
+
+        # MSPv1 has only eight bits for the id and size
+        return self.v2 or msgid > 255 or self._paysize(argtypes) > 255
+
+    def _direction(self, msgid):
+
+        # replies come from the FC (>), SET messages go to it (<)
+        return 62 if msgid < 200 else 60
+
+    def _header(self, msgid, direction, paysize, v2):
+
+        if v2:
+            return [36, 88, direction, 0, msgid & 0xFF, msgid >> 8, paysize & 0xFF, paysize >> 8]
+
+        return [36, 77, direction, paysize, msgid]
+
+    def _checksum(self, data, v2):
+
+        crc = 0
+
+        for b in data:
+            crc ^= b
+            if v2:
+                for _ in range(8):
+                    crc = ((crc << 1) ^ 0xD5) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+
+        return crc
+
+    def _request(self, msgid, v2):
+
+        # a request is a header with no payload, so its checksum is a constant
+        header = self._header(msgid, 60, 0, v2)
+
+        return header + [self._checksum(header[3:], v2)]
+
+    def _bool(self, v2):
+
+        return 'true' if v2 else 'false'
+
 
     def _getsrc(self, filename):
 
@@ -113,9 +155,9 @@ class Python_Emitter(CodeEmitter):
 
         CodeEmitter._copyfile(self, '%s.py' % name, 'python/' + ('%s.py' % name))
 
-    def __init__(self, msgdict):
+    def __init__(self, msgdict, v2):
 
-        CodeEmitter.__init__(self, 'python', 'py')
+        CodeEmitter.__init__(self, 'python', 'py', v2)
 
         for example in PYTHON_EXAMPLES:
             self._copy_example(example)
@@ -129,6 +171,7 @@ class Python_Emitter(CodeEmitter):
         self._write(self.warning('#'))
 
         self.type2pack = {'byte' : 'B', 'short' : 'h', 'float' : 'f', 'int' : 'i'}
+        self.type2unsigned = {'byte' : 'B', 'short' : 'H', 'float' : 'I', 'int' : 'I'}
 
         self._write(self._getsrc('top-py') + '\n')
 
@@ -136,18 +179,18 @@ class Python_Emitter(CodeEmitter):
             msgstuff = msgdict[msgtype]
             msgid = msgstuff[0]
             if msgid < 200:
-                self._write(4*self.indent + ('if self.message_id == %d:\n\n' % msgstuff[0]))
-                self._write(5*self.indent + ('if self.message_direction == 0:\n\n'))
-                self._write(6*self.indent + 'if hasattr(self, \'' +  msgtype + '_Request_Handler\'):\n\n')
-                self._write(7*self.indent + 'self.%s_Request_Handler()\n\n' % msgtype)
-                self._write(5*self.indent + 'else:\n\n')
-                self._write(6*self.indent + 'if hasattr(self, \'' +  msgtype + '_Handler\'):\n\n')
-                self._write(7*self.indent + 'self.%s_Handler(*struct.unpack(\'=' % msgtype)
+                self._write(2*self.indent + ('if message_id == %d:\n\n' % msgstuff[0]))
+                self._write(3*self.indent + ('if message_direction == 0:\n\n'))
+                self._write(4*self.indent + 'if hasattr(self, \'' +  msgtype + '_Request_Handler\'):\n\n')
+                self._write(5*self.indent + 'self.%s_Request_Handler()\n\n' % msgtype)
+                self._write(3*self.indent + 'else:\n\n')
+                self._write(4*self.indent + 'if hasattr(self, \'' +  msgtype + '_Handler\'):\n\n')
+                self._write(5*self.indent + 'self.%s_Handler(*struct.unpack(\'<' % msgtype)
                 for argtype in self._getargtypes(msgstuff):
                     self._write('%s' % self.type2pack[argtype])
-                self._write("\'" + ', self.message_buffer))\n\n')
+                self._write("\'" + ', message_buffer))\n\n')
 
-        self._write(self._getsrc('bottom-py') + '\n')
+        self._write('\n')
 
         # Emit handler methods for parser
         for msgtype in msgdict.keys():
@@ -170,23 +213,31 @@ class Python_Emitter(CodeEmitter):
             msgid = msgstuff[0]
 
             self._write('def serialize_' + msgtype + '(' + ', '.join(self._getargnames(msgstuff)) + '):\n\n')
-            self._write(self.indent + 'message_buffer = struct.pack(\'')
+            v2 = self._isv2(msgid, self._getargtypes(msgstuff))
+
+            self._write(self.indent + 'message_buffer = struct.pack(\'<')
             for argtype in self._getargtypes(msgstuff):
                 self._write(self.type2pack[argtype])
             self._write('\'')
             for argname in self._getargnames(msgstuff):
                 self._write(', ' + argname)
             self._write(')\n\n')
-            self._write(self.indent)
-
-            self._write('msg = chr(len(message_buffer)) + chr(%s) + str(message_buffer)\n\n' % msgid)
-            self._write(self.indent + 'return _bytes(\'$M%c\' + msg + chr(_CRC8(msg)))\n\n' %
-                    ('>' if msgid < 200 else '<'))
+            self._write(self.indent + 'return _frame(%d, %d, message_buffer, %s)\n\n' % 
+                    (self._direction(msgid), msgid, v2))
 
             if msgid < 200:
 
                 self._write('def serialize_' + msgtype + '_Request():\n\n')
-                self._write(self.indent + 'return _bytes(\'$M<\' + chr(0) + chr(%s) + chr(%s))\n\n' % (msgid, msgid))
+                self._write(self.indent + 'return _frame(60, %d, b\'\', %s)\n\n' % (msgid, v2))
+
+        # Emit unsigned field layouts for decoding TELEMETRY_DELTA records
+        self._write('_LAYOUTS = {\n')
+        for msgtype in msgdict.keys():
+            msgstuff = msgdict[msgtype]
+            if msgstuff[0] < 200:
+                self._write(self.indent + '%d: \'%s\',\n' % (msgstuff[0], 
+                    ''.join([self.type2unsigned[argtype] for argtype in self._getargtypes(msgstuff)])))
+        self._write('}\n')
 
     def _write(self, s):
 
@@ -196,9 +247,9 @@ class Python_Emitter(CodeEmitter):
 
 class CPP_Emitter(CodeEmitter):
 
-    def __init__(self, msgdict):
+    def __init__(self, msgdict, v2):
 
-        CodeEmitter.__init__(self, 'cpp', 'cpp')
+        CodeEmitter.__init__(self, 'cpp', 'cpp', v2)
         mkdir_if_missing('output/cpp/msppg')
 
         # Create C++ example
@@ -241,25 +292,25 @@ class CPP_Emitter(CodeEmitter):
             # Write handler code for incoming messages
             if msgid < 200:
 
-                self._cwrite(5*self.indent + ('case %s: {\n\n' % msgdict[msgtype][0]))
+                self._cwrite(2*self.indent + ('case %s: {\n\n' % msgdict[msgtype][0]))
                 nargs = len(argnames)
                 offset = 0
                 for k in range(nargs):
                     argname = argnames[k]
                     argtype = argtypes[k]
                     decl = self.type2decl[argtype]
-                    self._cwrite(6*self.indent + decl  + ' ' + argname + ';\n')
-                    self._cwrite(6*self.indent + 
-                            'memcpy(&%s,  &this->message_buffer[%d], sizeof(%s));\n\n' % 
+                    self._cwrite(3*self.indent + decl  + ' ' + argname + ';\n')
+                    self._cwrite(3*self.indent + 
+                            'memcpy(&%s,  &buffer[%d], sizeof(%s));\n\n' % 
                             (argname, offset, decl))
                     offset += self.type2size[argtype]
-                self._cwrite(6*self.indent + 'this->handlerFor%s->handle_%s(' % (msgtype, msgtype))
+                self._cwrite(3*self.indent + 'this->handlerFor%s->handle_%s(' % (msgtype, msgtype))
                 for k in range(nargs):
                     self._cwrite(argnames[k])
                     if k < nargs-1:
                         self._cwrite(', ')
                 self._cwrite(');\n')
-                self._cwrite(6*self.indent + '} break;\n\n')
+                self._cwrite(3*self.indent + '} break;\n\n')
                 
                 self._hwrite(self.indent*2 + 'static MSP_Message serialize_%s_Request();\n\n' % msgtype)
                 self._hwrite(self.indent*2 + 
@@ -279,6 +330,18 @@ class CPP_Emitter(CodeEmitter):
         self._hwrite('};\n');
 
         self._cwrite(self._getsrc('bottom-cpp'))
+
+        # Field widths for decoding TELEMETRY_DELTA records
+        self._cwrite('const char * MSP_Parser::layout(int id) {\n\n')
+        self._cwrite(self.indent + 'switch (id) {\n\n')
+        for msgtype in msgdict.keys():
+            msgstuff = msgdict[msgtype]
+            if msgstuff[0] < 200:
+                self._cwrite(2*self.indent + 'case %d: return "%s";\n' % (msgstuff[0],
+                    ''.join([str(self.type2size[argtype]) for argtype in self._getargtypes(msgstuff)])))
+        self._cwrite('\n' + self.indent + '}\n\n')
+        self._cwrite(self.indent + 'return NULL;\n')
+        self._cwrite('}\n\n')
  
         for msgtype in msgdict.keys():
 
@@ -287,6 +350,7 @@ class CPP_Emitter(CodeEmitter):
 
             argnames = self._getargnames(msgstuff)
             argtypes = self._getargtypes(msgstuff)
+            v2 = self._isv2(msgid, argtypes)
 
             # Incoming messages
             if msgid < 200:
@@ -308,15 +372,12 @@ class CPP_Emitter(CodeEmitter):
                 self._cwrite('}\n\n')
 
                 # Write request method
+                request = self._request(msgid, v2)
                 self._cwrite('MSP_Message MSP_Parser::serialize_%s_Request() {\n\n' % msgtype)
                 self._cwrite(self.indent + 'MSP_Message msg;\n\n')
-                self._cwrite(self.indent + 'msg.bytes[0] = 36;\n')
-                self._cwrite(self.indent + 'msg.bytes[1] = 77;\n')
-                self._cwrite(self.indent + 'msg.bytes[2] = %d;\n' % 60 if msgid < 200 else 62)
-                self._cwrite(self.indent + 'msg.bytes[3] = 0;\n')
-                self._cwrite(self.indent + 'msg.bytes[4] = %d;\n' % msgid)
-                self._cwrite(self.indent + 'msg.bytes[5] = %d;\n\n' % msgid)
-                self._cwrite(self.indent + 'msg.len = 6;\n\n')
+                for k in range(len(request)):
+                    self._cwrite(self.indent + 'msg.bytes[%d] = %d;\n' % (k, request[k]))
+                self._cwrite('\n' + self.indent + 'msg.len = %d;\n\n' % len(request))
                 self._cwrite(self.indent + 'return msg;\n')
                 self._cwrite('}\n\n')
 
@@ -328,13 +389,12 @@ class CPP_Emitter(CodeEmitter):
             self._cwrite(' {\n\n')
             self._cwrite(self.indent + 'MSP_Message msg;\n\n')
             msgsize = self._msgsize(argtypes)
-            self._cwrite(self.indent + 'msg.bytes[0] = 36;\n')
-            self._cwrite(self.indent + 'msg.bytes[1] = 77;\n')
-            self._cwrite(self.indent + 'msg.bytes[2] = 62;\n')
-            self._cwrite(self.indent + 'msg.bytes[3] = %d;\n' % msgsize)
-            self._cwrite(self.indent + 'msg.bytes[4] = %d;\n\n' % msgid)
+            header = self._header(msgid, self._direction(msgid), msgsize, v2)
+            for k in range(len(header)):
+                self._cwrite(self.indent + 'msg.bytes[%d] = %d;\n' % (k, header[k]))
+            self._cwrite('\n')
             nargs = len(argnames)
-            offset = 5
+            offset = len(header)
             for k in range(nargs):
                 argname = argnames[k]
                 argtype = argtypes[k]
@@ -343,9 +403,9 @@ class CPP_Emitter(CodeEmitter):
                         'memcpy(&msg.bytes[%d], &%s, sizeof(%s));\n' %  (offset, argname, decl))
                 offset += self.type2size[argtype]
             self._cwrite('\n')
-            self._cwrite(self.indent + 
-                    'msg.bytes[%d] = CRC8(&msg.bytes[3], %d);\n\n' % (msgsize+5, msgsize+2))
-            self._cwrite(self.indent + 'msg.len = %d;\n\n' % (msgsize+6))
+            self._cwrite(self.indent + 'msg.bytes[%d] = CRC8(&msg.bytes[3], %d, %s);\n\n' % 
+                    (offset, offset-3, self._bool(v2)))
+            self._cwrite(self.indent + 'msg.len = %d;\n\n' % (offset+1))
             self._cwrite(self.indent + 'return msg;\n')
             self._cwrite('}\n\n')
  
@@ -363,9 +423,9 @@ class CPP_Emitter(CodeEmitter):
 
 class C_Emitter(CodeEmitter):
 
-    def __init__(self, msgdict):
+    def __init__(self, msgdict, v2):
 
-        CodeEmitter.__init__(self, 'c', 'c')
+        CodeEmitter.__init__(self, 'c', 'c', v2)
         mkdir_if_missing('output/c/msppg')
         self._copyfile('example.c', 'c/example.c')
 
@@ -411,25 +471,25 @@ class C_Emitter(CodeEmitter):
             # Write handler code for incoming messages
             if msgid < 200:
 
-                self._cwrite(5*self.indent + ('case %s: {\n\n' % msgdict[msgtype][0]))
+                self._cwrite(2*self.indent + ('case %s: {\n\n' % msgdict[msgtype][0]))
                 nargs = len(argnames)
                 offset = 0
                 for k in range(nargs):
                     argname = argnames[k]
                     argtype = argtypes[k]
                     decl = self.type2decl[argtype]
-                    self._cwrite(6*self.indent + decl  + ' ' + argname + ';\n')
-                    self._cwrite(6*self.indent + 
-                            'memcpy(&%s,  &parser->message_buffer[%d], sizeof(%s));\n\n' % 
+                    self._cwrite(3*self.indent + decl  + ' ' + argname + ';\n')
+                    self._cwrite(3*self.indent + 
+                            'memcpy(&%s,  &buffer[%d], sizeof(%s));\n\n' % 
                             (argname, offset, decl))
                     offset += self.type2size[argtype]
-                self._cwrite(6*self.indent + 'parser->handler_for_%s(' % msgtype)
+                self._cwrite(3*self.indent + 'parser->handler_for_%s(' % msgtype)
                 for k in range(nargs):
                     self._cwrite(argnames[k])
                     if k < nargs-1:
                         self._cwrite(', ')
                 self._cwrite(');\n')
-                self._cwrite(6*self.indent + '} break;\n\n')
+                self._cwrite(3*self.indent + '} break;\n\n')
                 
                 self._hwrite('msp_message_t msp_serialize_%s_request();\n\n' % msgtype)
                 self._hwrite('void msp_set_%s_handler(msp_parser_t * parser, void (*handler)' % msgtype)
@@ -445,6 +505,7 @@ class C_Emitter(CodeEmitter):
 
             argnames = self._getargnames(msgstuff)
             argtypes = self._getargtypes(msgstuff)
+            v2 = self._isv2(msgid, argtypes)
 
             # Incoming messages
             if msgid < 200:
@@ -457,15 +518,12 @@ class C_Emitter(CodeEmitter):
                 self._cwrite('}\n\n')
 
                 # Write request method
-                self._cwrite('msp_message_t serialize_%s_Request() {\n\n' % msgtype)
+                request = self._request(msgid, v2)
+                self._cwrite('msp_message_t msp_serialize_%s_request() {\n\n' % msgtype)
                 self._cwrite(self.indent + 'msp_message_t msg;\n\n')
-                self._cwrite(self.indent + 'msg.bytes[0] = 36;\n')
-                self._cwrite(self.indent + 'msg.bytes[1] = 77;\n')
-                self._cwrite(self.indent + 'msg.bytes[2] = %d;\n' % 60 if msgid < 200 else 62)
-                self._cwrite(self.indent + 'msg.bytes[3] = 0;\n')
-                self._cwrite(self.indent + 'msg.bytes[4] = %d;\n' % msgid)
-                self._cwrite(self.indent + 'msg.bytes[5] = %d;\n\n' % msgid)
-                self._cwrite(self.indent + 'msg.len = 6;\n\n')
+                for k in range(len(request)):
+                    self._cwrite(self.indent + 'msg.bytes[%d] = %d;\n' % (k, request[k]))
+                self._cwrite('\n' + self.indent + 'msg.len = %d;\n\n' % len(request))
                 self._cwrite(self.indent + 'return msg;\n')
                 self._cwrite('}\n\n')
 
@@ -475,13 +533,12 @@ class C_Emitter(CodeEmitter):
             self._cwrite(' {\n\n')
             self._cwrite(self.indent + 'msp_message_t msg;\n\n')
             msgsize = self._msgsize(argtypes)
-            self._cwrite(self.indent + 'msg.bytes[0] = 36;\n')
-            self._cwrite(self.indent + 'msg.bytes[1] = 77;\n')
-            self._cwrite(self.indent + 'msg.bytes[2] = 62;\n')
-            self._cwrite(self.indent + 'msg.bytes[3] = %d;\n' % msgsize)
-            self._cwrite(self.indent + 'msg.bytes[4] = %d;\n\n' % msgid)
+            header = self._header(msgid, self._direction(msgid), msgsize, v2)
+            for k in range(len(header)):
+                self._cwrite(self.indent + 'msg.bytes[%d] = %d;\n' % (k, header[k]))
+            self._cwrite('\n')
             nargs = len(argnames)
-            offset = 5
+            offset = len(header)
             for k in range(nargs):
                 argname = argnames[k]
                 argtype = argtypes[k]
@@ -490,12 +547,16 @@ class C_Emitter(CodeEmitter):
                         'memcpy(&msg.bytes[%d], &%s, sizeof(%s));\n' %  (offset, argname, decl))
                 offset += self.type2size[argtype]
             self._cwrite('\n')
-            self._cwrite(self.indent + 
-                    'msg.bytes[%d] = CRC8(&msg.bytes[3], %d);\n\n' % (msgsize+5, msgsize+2))
-            self._cwrite(self.indent + 'msg.len = %d;\n\n' % (msgsize+6))
+            self._cwrite(self.indent + 'msg.bytes[%d] = CRC8(&msg.bytes[3], %d, %s);\n\n' % 
+                    (offset, offset-3, self._bool(v2)))
+            self._cwrite(self.indent + 'msg.len = %d;\n\n' % (offset+1))
             self._cwrite(self.indent + 'return msg;\n')
             self._cwrite('}\n\n')
  
+    def _bool(self, v2):
+
+        return '1' if v2 else '0'
+
     def _cwrite(self, s):
 
         self.coutput.write(s)
@@ -508,9 +569,9 @@ class C_Emitter(CodeEmitter):
 
 class Java_Emitter(CodeEmitter):
 
-    def __init__(self, msgdict):
+    def __init__(self, msgdict, v2):
 
-        CodeEmitter.__init__(self, 'java', 'java')
+        CodeEmitter.__init__(self, 'java', 'java', v2)
 
         self._copyfile('example.java', 'java/example.java')
 
@@ -536,9 +597,9 @@ class Java_Emitter(CodeEmitter):
 
             if msgid < 200:
 
-                self._write(6*self.indent + 'case (byte)%d:\n' % msgid)
-                self._write(7*self.indent + 'if (this.%s_handler != null) {\n' % msgtype)
-                self._write(8*self.indent + 'this.%s_handler.handle_%s(\n' % (msgtype, msgtype));
+                self._write(3*self.indent + 'case %d:\n' % msgid)
+                self._write(4*self.indent + 'if (this.%s_handler != null) {\n' % msgtype)
+                self._write(5*self.indent + 'this.%s_handler.handle_%s(\n' % (msgtype, msgtype));
 
                 argnames = self._getargnames(msgstuff)
                 argtypes = self._getargtypes(msgstuff)
@@ -548,14 +609,14 @@ class Java_Emitter(CodeEmitter):
                 offset = 0
                 for k in range(nargs):
                     argtype = argtypes[k]
-                    self._write(8*self.indent + 'bb.get%s(%d)' % (self.type2bb[argtype], offset))
+                    self._write(5*self.indent + 'bb.get%s(%d)' % (self.type2bb[argtype], offset))
                     offset += self.type2size[argtype]
                     if k < nargs-1:
                         self._write(',\n')
                 self._write(');\n')
 
-                self._write(7*self.indent + '}\n')
-                self._write(7*self.indent + 'break;\n\n')
+                self._write(4*self.indent + '}\n')
+                self._write(4*self.indent + 'break;\n\n')
 
         self._write(self._getsrc('bottom-java'))
 
@@ -566,6 +627,7 @@ class Java_Emitter(CodeEmitter):
 
             argnames = self._getargnames(msgstuff)
             argtypes = self._getargtypes(msgstuff)
+            v2 = self._isv2(msgid, argtypes)
 
             # For messages from FC
             if msgid < 200:
@@ -579,16 +641,11 @@ class Java_Emitter(CodeEmitter):
 
                 # Write serializer for requests
                 self._write(self.indent + 'public byte [] serialize_%s_Request() {\n\n' % msgtype)
-                paysize = self._paysize(argtypes)
-                msgsize = self._msgsize(argtypes)
-                self._write('\n' + 2*self.indent + 'byte [] message = new byte[6];\n\n')
-                self._write(2*self.indent + 'message[0] = 36;\n')
-                self._write(2*self.indent + 'message[1] = 77;\n')
-                self._write(2*self.indent + 'message[2] = 60;\n')
-                self._write(2*self.indent + 'message[3] = 0;\n')
-                self._write(2*self.indent + 'message[4] = (byte)%d;\n' % msgid)
-                self._write(2*self.indent + 'message[5] = (byte)%d;\n\n' % msgid)
-                self._write(2*self.indent + 'return message;\n')
+                request = self._request(msgid, v2)
+                self._write('\n' + 2*self.indent + 'byte [] message = new byte[%d];\n\n' % len(request))
+                for k in range(len(request)):
+                    self._write(2*self.indent + 'message[%d] = (byte)%d;\n' % (k, request[k]))
+                self._write('\n' + 2*self.indent + 'return message;\n')
                 self._write(self.indent + '}\n\n')
 
             # Write serializer method for messages from FC
@@ -600,19 +657,18 @@ class Java_Emitter(CodeEmitter):
             self._write(2*self.indent + 'ByteBuffer bb = newByteBuffer(%d);\n\n' % paysize)
             for (argname,argtype) in zip(argnames,argtypes):
                 self._write(2*self.indent + 'bb.put%s(%s);\n' % (self.type2bb[argtype], argname))
-            self._write('\n' + 2*self.indent + 'byte [] message = new byte[%d];\n' % (msgsize+6))
-            self._write(2*self.indent + 'message[0] = 36;\n')
-            self._write(2*self.indent + 'message[1] = 77;\n')
-            self._write(2*self.indent + 'message[2] = %d;\n' % (62 if msgid < 200 else 60))
-            self._write(2*self.indent + 'message[3] = %d;\n' % msgsize)
-            self._write(2*self.indent + 'message[4] = (byte)%d;\n' %msgdict[msgtype][0]) 
+            header = self._header(msgid, self._direction(msgid), msgsize, v2)
+            offset = len(header)
+            self._write('\n' + 2*self.indent + 'byte [] message = new byte[%d];\n' % (offset+msgsize+1))
+            for k in range(offset):
+                self._write(2*self.indent + 'message[%d] = (byte)%d;\n' % (k, header[k]))
             self._write(2*self.indent + 'byte [] data = bb.array();\n')
             self._write(2*self.indent + 'int k;\n')
             self._write(2*self.indent + 'for (k=0; k<data.length; ++k) {\n')
-            self._write(3*self.indent + 'message[k+5] = data[k];\n')
+            self._write(3*self.indent + 'message[k+%d] = data[k];\n' % offset)
             self._write(2*self.indent + '}\n\n')
-            self._write(2*self.indent + 'message[%d] = CRC8(message, 3, %d);\n\n' % 
-                    (msgsize+5, msgsize+4))
+            self._write(2*self.indent + 'message[%d] = CRC8(message, 3, %d, %s);\n\n' % 
+                    (offset+msgsize, offset+msgsize, self._bool(v2)))
             self._write(2*self.indent + 'return message;\n')
             self._write(self.indent + '}\n\n')
 
@@ -648,8 +704,12 @@ class Java_Emitter(CodeEmitter):
 
 if __name__ == '__main__':
 
+    # --v2 frames every message as MSPv2; otherwise only those that don't fit MSPv1
+    args = [arg for arg in argv[1:] if arg != '--v2']
+    v2 = '--v2' in argv[1:]
+
     # default to input from simple example
-    data = json.load(open(argv[1] if len(argv) > 1 else 'messages.json', 'r'))
+    data = json.load(open(args[0] if len(args) > 0 else 'messages.json', 'r'))
  
     # takes the types of messages from the json file
     unicode_message_types = data.keys()
@@ -687,13 +747,13 @@ if __name__ == '__main__':
     mkdir_if_missing('output')
 
     # Emit Python
-    Python_Emitter(msgdict)
+    Python_Emitter(msgdict, v2)
 
     # Emit C++
-    CPP_Emitter(msgdict)
+    CPP_Emitter(msgdict, v2)
 
     # Emit C
-    C_Emitter(msgdict)
+    C_Emitter(msgdict, v2)
 
     # Emite Java
-    Java_Emitter(msgdict)
+    Java_Emitter(msgdict, v2)
@@ -36,6 +36,12 @@ void Board::imuRead(int16_t accADC[3], int16_t gyroADC[3])
 {
 }
 
+bool Board::imuStartInterrupt(class ImuRing * ring)
+{
+    (void)ring;
+    return false;
+}
+
 void Board::init(uint32_t & looptimeMicroseconds, uint32_t & calibratingGyroMsec)
 {
     looptimeMicroseconds = Board::DEFAULT_IMU_LOOPTIME_USEC; 
@@ -56,6 +62,16 @@ uint32_t Board::getMicros()
     return micros();
 }
 
+uint32_t Board::getTicks(void)
+{
+    return micros();
+}
+
+uint32_t Board::getTicksPerMicrosecond(void)
+{
+    return 1;
+}
+
 void Board::ledSetState(uint8_t id, bool state)
 {
 }
@@ -70,26 +86,55 @@ uint16_t Board::rcReadPWM(uint8_t chan)
     return 0;
 }
 
-uint8_t Board::serialAvailableBytes(void)
+uint16_t Board::serialRead(uint8_t * data, uint16_t maxCount)
 {
     return 0;
 }
 
-uint8_t Board::serialReadByte(void)
+uint16_t Board::serialWrite(const uint8_t * data, uint16_t count)
+{
+    return count;
+}
+
+void Board::writeMotor(uint8_t index, uint16_t value)
 {
-    return 0;
 }
 
-void Board::serialWriteByte(uint8_t c)
+uint8_t Board::motorCount(void)
 {
+    return 4;
 }
 
-void Board::writeMotor(uint8_t index, uint16_t value)
+void Board::completeMotorUpdate(void)
 {
 }
 
+bool Board::motorRpm(uint8_t index, uint16_t & rpm)
+{
+    (void)index;
+    (void)rpm;
+    return false;
+}
+
 // unused --------------------------------------------------------------------------
 
+bool Board::blackboxInit(void)
+{
+    return false;
+}
+
+uint16_t Board::blackboxWrite(const uint8_t * data, uint16_t count)
+{
+    (void)data;
+    (void)count;
+    return 0;
+}
+
+uint16_t Board::batteryMillivolts(void)
+{
+    return 0;
+}
+
 bool Board::baroInit(void)
 {
     return false;
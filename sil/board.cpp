@@ -0,0 +1,471 @@
+/*
+   board.cpp : implementation of board-specific routines
+
+   This implementation runs the firmware against a simulated quadcopter and a
+   virtual microsecond clock, so that no real time need elapse between calls.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+#include "board.hpp"
+#include "imuring.hpp"
+#include "rc.hpp"
+#include "dshot.hpp"
+
+#include "sil.hpp"
+
+// Shorter than a real board, like the V-REP simulator
+static const uint32_t SIL_GYRO_CALIBRATION_MSEC = 100;
+
+// Data-ready rate of the simulated MPU6050
+static const uint32_t SIL_IMU_SAMPLE_USEC = 1000;
+
+// Sonar range limits, in cm
+static const uint16_t SIL_SONAR_MIN = 20;
+static const uint16_t SIL_SONAR_MAX = 765;
+
+// In-memory serial link between the runner and the firmware's MSP
+#define SIL_SERIAL_BUFSIZE 1024
+
+typedef struct serialQueue_t {
+    uint8_t  buf[SIL_SERIAL_BUFSIZE];
+    uint16_t head;
+    uint16_t tail;
+} serialQueue_t;
+
+static serialQueue_t toFirmware;
+static serialQueue_t fromFirmware;
+
+static void queuePut(serialQueue_t * q, uint8_t c)
+{
+    uint16_t next = (q->head + 1) % SIL_SERIAL_BUFSIZE;
+
+    // drop on overflow, like a UART with nobody listening
+    if (next != q->tail) {
+        q->buf[q->head] = c;
+        q->head = next;
+    }
+}
+
+static uint16_t queueCount(serialQueue_t * q)
+{
+    return (q->head + SIL_SERIAL_BUFSIZE - q->tail) % SIL_SERIAL_BUFSIZE;
+}
+
+static uint8_t queueGet(serialQueue_t * q)
+{
+    uint8_t c = q->buf[q->tail];
+    q->tail = (q->tail + 1) % SIL_SERIAL_BUFSIZE;
+    return c;
+}
+
+// Blackbox log device: a 16 MB SPI flash, programmed a 256-byte page at a time.  A page
+// program keeps the chip busy for its typical 0.7 msec, whatever was written to the page.
+#define SIL_FLASH_BYTES     (16 * 1024 * 1024)
+#define SIL_FLASH_PAGE      256
+#define SIL_FLASH_PAGE_USEC 700
+
+static uint8_t  flash[SIL_FLASH_BYTES];
+static uint32_t flashUsed;
+static uint32_t flashReadyTime;
+
+// The simulated ESCs speak bidirectional DShot: each decodes its frame to a throttle and
+// answers with its commutation period, as the line samples a board would capture
+#define SIL_TELEMETRY_SAMPLES   (4 + DSHOT_TELEMETRY_OVERSAMPLE * DSHOT_TELEMETRY_BITS + 4)
+
+static uint16_t escFrame[4];
+static uint32_t escReply[4][SIL_TELEMETRY_SAMPLES];
+
+// nibble to 5-bit GCR code
+static const uint8_t GCR_ENCODE[16] = {
+    0x19, 0x1B, 0x12, 0x13, 0x1D, 0x15, 0x16, 0x17, 0x1A, 0x09, 0x0A, 0x0B, 0x1E, 0x0D, 0x0E, 0x0F
+};
+
+// ESC side of a bidirectional frame: throttle in [0,1], or -1 for a bad checksum
+static float escThrottle(uint16_t frame)
+{
+    uint16_t packet = frame >> 4;
+    uint16_t checksum = ~(packet ^ (packet >> 4) ^ (packet >> 8)) & 0x0F;
+
+    if (checksum != (frame & 0x0F))
+        return -1;
+
+    uint16_t value = packet >> 1;
+
+    return value < DSHOT_MIN_THROTTLE ? 0 : 
+        (float)(value - DSHOT_MIN_THROTTLE) / (DSHOT_MAX_THROTTLE - DSHOT_MIN_THROTTLE);
+}
+
+static void escTelemetry(float rpm, uint32_t samples[SIL_TELEMETRY_SAMPLES])
+{
+    // commutation period as a 9-bit mantissa and 3-bit shift; all ones for stopped
+    float erpm = rpm * (CONFIG_MOTOR_POLES / 2);
+    uint32_t period = erpm > 0 ? (uint32_t)(60e6f / erpm) : 0xFFFFFFFF;
+    uint8_t shift = 0;
+    while (period > 0x1FF && shift < 7) {
+        period >>= 1;
+        shift++;
+    }
+    uint16_t value = period > 0x1FF ? 0x0FFF : (shift << 9) | period;
+
+    uint16_t checksum = ~(value ^ (value >> 4) ^ (value >> 8)) & 0x0F;
+    uint16_t packet = (value << 4) | checksum;
+
+    uint32_t gcr = 0;
+    for (int8_t n=3; n>=0; --n)
+        gcr = (gcr << 5) | GCR_ENCODE[(packet >> (4*n)) & 0x0F];
+
+    // start bit, then a transition for each one
+    uint32_t bits = (1 << 20) | gcr;
+    bool level = true;
+    uint8_t k = 0;
+    while (k < 4)
+        samples[k++] = level;
+    for (int8_t b=DSHOT_TELEMETRY_BITS-1; b>=0; --b) {
+        if (bits & (1 << b))
+            level = !level;
+        for (uint8_t j=0; j<DSHOT_TELEMETRY_OVERSAMPLE; ++j)
+            samples[k++] = level;
+    }
+    while (k < SIL_TELEMETRY_SAMPLES)
+        samples[k++] = true;
+}
+
+static QuadModel model;
+static uint32_t  micros;
+static float     demands[5];
+static bool      armed;
+static ImuRing * imuRing;
+static uint32_t  imuSampleTime;
+static bool      imuInterrupt;
+
+// Runner interface -----------------------------------------------------------------------
+
+void silInit(uint32_t seed, bool _imuInterrupt)
+{
+    model.init(seed);
+    micros = 0;
+    armed = false;
+    imuRing = NULL;
+    imuInterrupt = _imuInterrupt;
+    toFirmware.head = toFirmware.tail = 0;
+    fromFirmware.head = fromFirmware.tail = 0;
+    flashUsed = 0;
+
+    // Sticks centered, throttle down, aux switch off
+    for (uint8_t k=0; k<5; ++k)
+        demands[k] = 0;
+    demands[DEMAND_THROTTLE] = -1;
+    demands[DEMAND_AUX1] = -1;
+}
+
+void silStep(uint32_t usec)
+{
+    model.update(usec * 1e-6f);
+    micros += usec;
+
+    // stands in for the data-ready interrupt
+    if (imuRing && (int32_t)(micros - imuSampleTime) >= 0) {
+        int16_t accADC[3], gyroADC[3];
+        model.readIMU(accADC, gyroADC);
+        imuRing->push(micros, accADC, gyroADC);
+        imuSampleTime += SIL_IMU_SAMPLE_USEC;
+    }
+}
+
+uint32_t silMicros(void)
+{
+    return micros;
+}
+
+void silSetDemands(const float _demands[5])
+{
+    for (uint8_t k=0; k<5; ++k)
+        demands[k] = _demands[k];
+}
+
+bool silArmed(void)
+{
+    return armed;
+}
+
+QuadModel & silModel(void)
+{
+    return model;
+}
+
+void silSerialWrite(const uint8_t * buf, uint16_t len)
+{
+    for (uint16_t k=0; k<len; ++k)
+        queuePut(&toFirmware, buf[k]);
+}
+
+uint16_t silSerialRead(uint8_t * buf, uint16_t maxlen)
+{
+    uint16_t k = 0;
+    while (k < maxlen && queueCount(&fromFirmware))
+        buf[k++] = queueGet(&fromFirmware);
+    return k;
+}
+
+uint32_t silBlackbox(const uint8_t ** data)
+{
+    *data = flash;
+    return flashUsed;
+}
+
+// Essentials -----------------------------------------------------------------------------
+
+void Board::imuInit(uint16_t & acc1G, float & gyroScale)
+{
+    acc1G = MODEL_ACC_1G;
+    gyroScale = (1.0f / MODEL_GYRO_LSB_PER_DPS) * (M_PI / 180.0f);
+}
+
+void Board::imuRead(int16_t accADC[3], int16_t gyroADC[3])
+{
+    model.readIMU(accADC, gyroADC);
+}
+
+bool Board::imuStartInterrupt(ImuRing * ring)
+{
+    if (!imuInterrupt)
+        return false;
+
+    imuRing = ring;
+    imuSampleTime = micros;
+    return true;
+}
+
+void Board::init(uint32_t & looptimeMicroseconds, uint32_t & calibratingGyroMsec)
+{
+    looptimeMicroseconds = Board::DEFAULT_IMU_LOOPTIME_USEC;
+    calibratingGyroMsec  = SIL_GYRO_CALIBRATION_MSEC;
+}
+
+void Board::delayMilliseconds(uint32_t msec)
+{
+    for (uint32_t k=0; k<msec*1000/SIL_TICK_USEC; ++k)
+        silStep(SIL_TICK_USEC);
+}
+
+uint32_t Board::getMicros()
+{
+    return micros;
+}
+
+// The virtual clock stands still inside loop(), so profile with the host's clock instead
+uint32_t Board::getTicks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+uint32_t Board::getTicksPerMicrosecond(void)
+{
+    return 1000;
+}
+
+void Board::ledSetState(uint8_t id, bool state)
+{
+    (void)id;
+    (void)state;
+}
+
+bool Board::rcUseSerial(void)
+{
+    return false;
+}
+
+uint16_t Board::rcReadPWM(uint8_t chan)
+{
+    float demand = chan < 5 ? demands[chan] : 0;
+
+    // Demands are in [-1,+1]
+    return (uint16_t)(CONFIG_PWM_MIN + (demand + 1) / 2 * (CONFIG_PWM_MAX - CONFIG_PWM_MIN));
+}
+
+uint16_t Board::serialRead(uint8_t * data, uint16_t maxCount)
+{
+    uint16_t count = 0;
+
+    while (count < maxCount && queueCount(&toFirmware))
+        data[count++] = queueGet(&toFirmware);
+
+    return count;
+}
+
+uint16_t Board::serialWrite(const uint8_t * data, uint16_t count)
+{
+    // like a transmit ring, take only what fits until the runner reads some out
+    uint16_t room = SIL_SERIAL_BUFSIZE - 1 - queueCount(&fromFirmware);
+
+    if (count > room)
+        count = room;
+
+    for (uint16_t k=0; k<count; ++k)
+        queuePut(&fromFirmware, data[k]);
+
+    return count;
+}
+
+void Board::serialDebugByte(uint8_t c)
+{
+    putchar(c);
+}
+
+void Board::writeMotor(uint8_t index, uint16_t value)
+{
+    escFrame[index] = dshotFrame(dshotThrottle(value), false, true);
+}
+
+void Board::completeMotorUpdate(void)
+{
+    for (uint8_t i=0; i<4; ++i) {
+
+        // like a real ESC, ignore a corrupt frame
+        float throttle = escThrottle(escFrame[i]);
+        if (throttle >= 0)
+            model.setMotor(i, throttle);
+
+        escTelemetry(model.rpm[i], escReply[i]);
+    }
+}
+
+bool Board::motorRpm(uint8_t index, uint16_t & rpm)
+{
+    uint32_t periodUsec;
+
+    if (!dshotDecodeSamples(escReply[index], SIL_TELEMETRY_SAMPLES, 1, periodUsec))
+        return false;
+
+    rpm = dshotRpm(periodUsec);
+
+    return true;
+}
+
+uint8_t Board::motorCount(void)
+{
+    return 4;
+}
+
+void Board::showArmedStatus(bool _armed)
+{
+    armed = _armed;
+}
+
+void Board::showAuxStatus(uint8_t status)
+{
+    (void)status;
+}
+
+// Sonar: only the bottom-facing one (index 1) sees anything
+
+bool Board::sonarInit(uint8_t index)
+{
+    (void)index;
+    return true;
+}
+
+void Board::sonarUpdate(uint8_t index)
+{
+    (void)index;
+}
+
+uint16_t Board::sonarGetDistance(uint8_t index)
+{
+    if (index != 1)
+        return SIL_SONAR_MAX;
+
+    int32_t cm = (int32_t)(100 * model.getAltitude());
+
+    return (uint16_t)(cm < SIL_SONAR_MIN ? SIL_SONAR_MIN : (cm > SIL_SONAR_MAX ? SIL_SONAR_MAX : cm));
+}
+
+bool Board::blackboxInit(void)
+{
+    flashReadyTime = micros;
+    return true;
+}
+
+uint16_t Board::blackboxWrite(const uint8_t * data, uint16_t count)
+{
+    if ((int32_t)(micros - flashReadyTime) < 0)
+        return 0;
+
+    // no further than the end of the page, or of the chip
+    uint32_t room = SIL_FLASH_PAGE - flashUsed % SIL_FLASH_PAGE;
+    if (room > SIL_FLASH_BYTES - flashUsed)
+        room = SIL_FLASH_BYTES - flashUsed;
+    if (count > room)
+        count = room;
+
+    for (uint16_t k=0; k<count; ++k)
+        flash[flashUsed++] = data[k];
+
+    if (count)
+        flashReadyTime = micros + SIL_FLASH_PAGE_USEC;
+
+    return count;
+}
+
+// 3S pack sagging under load
+uint16_t Board::batteryMillivolts(void)
+{
+    float load = 0;
+    for (uint8_t i=0; i<4; ++i) {
+        float n = model.rpm[i] / MODEL_MAX_RPM;
+        load += n * n / 4;
+    }
+
+    return (uint16_t)(12600 - 1500 * load);
+}
+
+// Unused ---------------------------------------------------------------------------------
+
+bool Board::baroInit(void)
+{
+    return false;
+}
+
+void Board::baroUpdate(void)
+{
+}
+
+int32_t Board::baroGetPressure(void)
+{
+    return 0;
+}
+
+void Board::reboot(void)
+{
+}
+
+bool Board::rcSerialReady(void)
+{
+    return false;
+}
+
+uint16_t Board::rcReadSerial(uint8_t chan)
+{
+    (void)chan;
+    return 0;
+}
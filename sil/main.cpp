@@ -0,0 +1,657 @@
+/*
+   main.cpp : Headless software-in-the-loop runner for Hackflight
+
+   Runs setup() and loop() against a simulated quadcopter as fast as the host
+   allows, flying a scripted stick profile, then reports how the vehicle
+   behaved and how many simulated seconds were achieved per wall-clock second.
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+
+#include "sil.hpp"
+#include "fastmath.hpp"
+
+extern void setup(void);
+extern void loop(void);
+
+// Stick profile: start time (sec), then roll, pitch, yaw, throttle, aux demands in [-1,+1].
+// The profile repeats for as long as the run lasts.
+static const float PROFILE[][6] = {
+    {  0.0f,  0.0f,  0.0f,  0.0f, -1.00f, -1 },   // settle, calibrate
+    {  1.0f,  0.0f,  0.0f, +1.0f, -1.00f, -1 },   // yaw right to arm (and roll right too, for autotune)
+    {  2.0f,  0.0f,  0.0f,  0.0f, -1.00f, -1 },
+    {  3.0f,  0.0f,  0.0f,  0.0f, +0.30f, -1 },   // climb
+    {  4.5f,  0.0f,  0.0f,  0.0f, +0.19f, -1 },   // approximately hover
+    {  8.0f, +0.3f,  0.0f,  0.0f, +0.19f, -1 },   // roll right
+    {  9.0f,  0.0f,  0.0f,  0.0f, +0.19f, -1 },
+    { 11.0f,  0.0f, +0.3f,  0.0f, +0.19f, -1 },   // pitch forward
+    { 12.0f,  0.0f,  0.0f,  0.0f, +0.19f, -1 },
+    { 14.0f, -0.3f, -0.3f,  0.0f, +0.19f, -1 },   // back left
+    { 15.0f,  0.0f,  0.0f,  0.0f, +0.19f, -1 },
+    { 17.0f,  0.0f,  0.0f, +0.5f, +0.19f, -1 },   // yaw right
+    { 18.0f,  0.0f,  0.0f,  0.0f, +0.19f, -1 },
+    { 20.0f,  0.0f,  0.0f,  0.0f, +0.10f, -1 },   // descend
+    { 26.0f,  0.0f,  0.0f,  0.0f, -1.00f, -1 },
+    { 27.0f,  0.0f,  0.0f, -1.0f, -1.00f, -1 },   // yaw left to disarm
+    { 28.0f,  0.0f,  0.0f,  0.0f, -1.00f, -1 },
+};
+
+static const int   PROFILE_STEPS = sizeof(PROFILE) / sizeof(PROFILE[0]);
+static const float PROFILE_PERIOD_SEC = 30.0f;
+
+static const float DEFAULT_DURATION_SEC = 60.0f;
+static const float TRACE_PERIOD_SEC     = 0.1f;
+
+static const int   PROFILE_ARM_STEP = 1;
+
+static void getDemands(float t, bool autotune, float demands[5])
+{
+    float tp = fmodf(t, PROFILE_PERIOD_SEC);
+
+    int step = 0;
+    while (step < PROFILE_STEPS-1 && PROFILE[step+1][0] <= tp)
+        step++;
+
+    for (int k=0; k<5; ++k)
+        demands[k] = PROFILE[step][k+1];
+
+    if (autotune && step == PROFILE_ARM_STEP)
+        demands[0] = +1;
+}
+
+static double wallSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Timing reports, fetched from the firmware over MSP like a ground station would
+static const uint8_t MSP_RC              = 105;
+static const uint8_t MSP_ATTITUDE        = 108;
+static const uint8_t MSP_LOOP_TIMING     = 121;
+static const uint8_t MSP_TASKS           = 123;
+static const uint8_t MSP_AUTOTUNE        = 125;
+static const uint8_t MSP_TELEMETRY       = 130;
+static const uint8_t MSP_TELEMETRY_DELTA = 131;
+static const uint8_t MSP_BLACKBOX        = 132;
+static const uint8_t MSP_SET_TELEMETRY   = 230;
+
+static const char * STAGE_NAMES[] = {"imu", "expo", "msp", "hover", "stabilize", "mixer", "blackbox", "loop", "period"};
+static const int    STAGE_COUNT = sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]);
+
+// Set in a loop-timing value that is in whole microseconds rather than tenths
+static const uint16_t TIMING_USEC = 0x8000;
+
+static const char * TASK_NAMES[] = {"gyro", "rate", "imu", "rc", "altitude", "sonars", "msp", "dynnotch", "blackbox"};
+static const int    TASK_COUNT = sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]);
+
+static uint16_t get16(const uint8_t * p)
+{
+    return p[0] | p[1]<<8;
+}
+
+static uint32_t get32(const uint8_t * p)
+{
+    return get16(p) | (uint32_t)get16(p+2)<<16;
+}
+
+static uint8_t crc8DvbS2(const uint8_t * data, int len)
+{
+    uint8_t crc = 0;
+
+    for (int k=0; k<len; ++k) {
+        crc ^= data[k];
+        for (int b=0; b<8; ++b)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0xD5 : crc << 1;
+    }
+
+    return crc;
+}
+
+static void mspSend(uint16_t id, const uint8_t * data, uint16_t size)
+{
+    uint8_t frame[9+256] = {'$', 'X', '<', 0, (uint8_t)id, (uint8_t)(id>>8), (uint8_t)size, (uint8_t)(size>>8)};
+    memcpy(&frame[8], data, size);
+    frame[8+size] = crc8DvbS2(&frame[3], 5+size);
+    silSerialWrite(frame, 9+size);
+}
+
+// Runs the firmware long enough for its MSP task to see what was sent
+static void mspWait(void)
+{
+    for (int k=0; k<100; ++k) {
+        silStep(SIL_TICK_USEC);
+        loop();
+    }
+}
+
+// Checks one MSPv2 reply at the start of buf; returns its payload size, or -1 if invalid
+static int mspReply(const uint8_t * buf, int len, uint16_t id, uint8_t * payload, int maxlen)
+{
+    if (len < 9 || buf[0] != '$' || buf[1] != 'X' || buf[2] != '>')
+        return -1;
+
+    uint16_t size = get16(&buf[6]);
+
+    if (get16(&buf[4]) != id || size > len-9 || size > maxlen || crc8DvbS2(&buf[3], size+5) != buf[size+8])
+        return -1;
+
+    memcpy(payload, &buf[8], size);
+
+    return size;
+}
+
+// Sends an MSPv2 request; returns payload size, or -1 if no valid reply
+static int mspRequest(uint16_t id, uint8_t * payload, int maxlen)
+{
+    mspSend(id, NULL, 0);
+    mspWait();
+
+    uint8_t reply[512];
+    uint16_t len = silSerialRead(reply, sizeof(reply));
+
+    int size = mspReply(reply, len, id, payload, maxlen);
+
+    return size == len-9 ? size : -1;
+}
+
+static double timingUsec(uint16_t value)
+{
+    return value & TIMING_USEC ? value & ~TIMING_USEC : value / 10.;
+}
+
+static void reportTiming(void)
+{
+    uint8_t payload[256];
+
+    if (mspRequest(MSP_LOOP_TIMING, payload, sizeof(payload)) != 6*STAGE_COUNT) {
+        printf("No loop-timing reply\n");
+        return;
+    }
+
+    printf("Stage       min usec  max usec  mean usec\n");
+    for (int k=0; k<STAGE_COUNT; ++k) {
+        uint8_t * p = &payload[6*k];
+        printf("%-10s %9.1f %9.1f %10.1f\n", STAGE_NAMES[k], timingUsec(get16(p)), timingUsec(get16(p+2)), timingUsec(get16(p+4)));
+    }
+
+    if (mspRequest(MSP_TASKS, payload, sizeof(payload)) != 12*TASK_COUNT) {
+        printf("No task reply\n");
+        return;
+    }
+
+    printf("Task        max usec  budget  misses  deferrals\n");
+    for (int k=0; k<TASK_COUNT; ++k) {
+        uint8_t * p = &payload[12*k];
+        printf("%-10s %9d %7d %7u %10u\n", TASK_NAMES[k], get16(p), get16(p+2), get32(p+4), get32(p+8));
+    }
+
+    if (mspRequest(MSP_BLACKBOX, payload, sizeof(payload)) != 12) {
+        printf("No blackbox reply\n");
+        return;
+    }
+
+    uint32_t frames = get32(payload);
+    printf("Blackbox: %u frames at %.1f bytes per frame, %u lost\n",
+            frames, frames ? (double)get32(payload+4) / frames : 0., get32(payload+8));
+}
+
+static void reportAutotune(void)
+{
+    static const char * STATES[] = {"off", "waiting", "running", "done", "failed"};
+    static const char * AXES[]   = {"roll", "pitch", "yaw"};
+
+    uint8_t payload[256];
+
+    if (mspRequest(MSP_AUTOTUNE, payload, sizeof(payload)) != 2+7*3) {
+        printf("No autotune reply\n");
+        return;
+    }
+
+    printf("Autotune: %s", payload[0] < 5 ? STATES[payload[0]] : "?");
+    if (payload[0] == 4)
+        printf(" on %s", payload[1] < 3 ? AXES[payload[1]] : "?");
+    printf("\n");
+
+    printf("Axis       P    I    D  period msec  amplitude dps\n");
+    for (int k=0; k<3; ++k) {
+        uint8_t * p = &payload[2+7*k];
+        printf("%-6s %4d %4d %4d %12d %14d\n", AXES[k], p[0], p[1], p[2], get16(p+3), get16(p+5));
+    }
+}
+
+static uint32_t getVarint(const uint8_t * buf, int & pos)
+{
+    uint32_t value = 0;
+    for (int shift=0; ; shift+=7) {
+        value |= (uint32_t)(buf[pos] & 0x7F) << shift;
+        if (!(buf[pos++] & 0x80))
+            return value;
+    }
+}
+
+// Subscribes to attitude at 50 Hz and receiver channels at 10 Hz, then counts what the firmware
+// pushes over one simulated second against what request/reply polling of MSPv1 would have cost
+static void reportTelemetry(bool delta)
+{
+    static const uint16_t SUBSCRIPTIONS[][3] = {{MSP_ATTITUDE, 20, 6}, {MSP_RC, 100, 16}};  // id, msec, size
+    static const int      SUBSCRIPTION_COUNT = sizeof(SUBSCRIPTIONS) / sizeof(SUBSCRIPTIONS[0]);
+
+    uint8_t request[4*SUBSCRIPTION_COUNT+1];
+    for (int k=0; k<SUBSCRIPTION_COUNT; ++k) {
+        request[4*k+0] = (uint8_t)SUBSCRIPTIONS[k][0];
+        request[4*k+1] = SUBSCRIPTIONS[k][0] >> 8;
+        request[4*k+2] = (uint8_t)SUBSCRIPTIONS[k][1];
+        request[4*k+3] = SUBSCRIPTIONS[k][1] >> 8;
+    }
+    request[4*SUBSCRIPTION_COUNT] = delta;
+
+    // the first push can follow the acknowledgement straight away
+    static uint8_t stream[16384];
+    mspSend(MSP_SET_TELEMETRY, request, sizeof(request));
+    mspWait();
+    int len = silSerialRead(stream, sizeof(stream));
+
+    uint8_t payload[256];
+    if (mspReply(stream, len, MSP_SET_TELEMETRY, payload, sizeof(payload)) != 0) {
+        printf("No telemetry subscription\n");
+        return;
+    }
+
+    for (int k=0; k<2000-100; ++k) {
+        silStep(SIL_TICK_USEC);
+        loop();
+        len += silSerialRead(&stream[len], sizeof(stream)-len);
+    }
+
+    // anything pushed since, and the acknowledgement, aren't counted
+    uint8_t unsubscribed[512];
+    mspSend(MSP_SET_TELEMETRY, NULL, 0);
+    mspWait();
+    silSerialRead(unsubscribed, sizeof(unsubscribed));
+
+    int frames = 0;
+    int records[SUBSCRIPTION_COUNT] = {0};
+    int pollBytes = 0;
+
+    for (int pos=9; pos<len; ) {
+        int size = mspReply(&stream[pos], len-pos, delta ? MSP_TELEMETRY_DELTA : MSP_TELEMETRY, payload, sizeof(payload));
+        if (size < 0) {
+            printf("Bad telemetry frame\n");
+            return;
+        }
+        frames++;
+        // (id, size, payload) records, or a sequence number and (id and key flag, length, coded fields)
+        for (int r=delta; r<size; ) {
+            uint16_t id = delta ? getVarint(payload, r) >> 1 : get16(&payload[r]);
+            int length = delta ? getVarint(payload, r) : payload[r+2];
+            r += (delta ? 0 : 3) + length;
+            for (int k=0; k<SUBSCRIPTION_COUNT; ++k)
+                if (id == SUBSCRIPTIONS[k][0]) {
+                    records[k]++;
+                    pollBytes += 6 + 6 + SUBSCRIPTIONS[k][2];
+                }
+        }
+        pos += 9 + size;
+    }
+
+    printf("%s: %d frames, %d attitude, %d receiver in one second: %d bytes, polling %d\n",
+            delta ? "Delta telemetry" : "Telemetry", frames, records[0], records[1], len-9, pollBytes);
+}
+
+// Saves what the blackbox wrote to the simulated flash, and decodes it using nothing but its headers
+static void reportBlackbox(const char * filename)
+{
+    static const int MAX_FIELDS = 64;
+
+    const uint8_t * log;
+    uint32_t size = silBlackbox(&log);
+
+    FILE * fp = fopen(filename, "wb");
+    if (!fp || fwrite(log, 1, size, fp) != size) {
+        perror(filename);
+        exit(1);
+    }
+    fclose(fp);
+
+    char     names[MAX_FIELDS][32];
+    int      intraPredictor[MAX_FIELDS];
+    int      intraEncoding[MAX_FIELDS];
+    int      interPredictor[MAX_FIELDS];
+    int      group[MAX_FIELDS];
+    uint32_t values[MAX_FIELDS];
+    uint32_t previous[MAX_FIELDS];
+    uint32_t beforePrevious[MAX_FIELDS];
+
+    int fields = 0;
+    int divisor = 1;
+    int logs = 0;
+    int frames[2] = {0};
+    int missing = 0;
+    int frameBytes = 0;
+    bool   inLog = false;
+    double seconds = 0;
+
+    for (int pos=0; pos<(int)size; ) {
+
+        uint8_t marker = log[pos];
+
+        if (marker == 'H') {
+            const char * line = (const char *)&log[pos];
+            const char * end = (const char *)memchr(line, '\n', size-pos);
+            if (!end)
+                break;
+            const char * colon = (const char *)memchr(line, ':', end-line);
+            const char * p = colon ? colon+1 : end;
+            int count = 0;
+            if (!strncmp(line, "H Product:", 10)) {
+                logs++;
+                fields = 0;
+                inLog = false;
+            }
+            else if (!strncmp(line, "H Divisor:", 10))
+                divisor = atoi(p);
+            else if (!strncmp(line, "H Field names:", 14))
+                for (; p < end && count < MAX_FIELDS; p += strcspn(p, ",\n") + 1) {
+                    int length = strcspn(p, ",\n");
+                    snprintf(names[count], sizeof(names[count]), "%.*s", length, p);
+                    // the first field of a group is the one that others can be predicted from
+                    int prefix = strcspn(names[count], "[");
+                    group[count] = count;
+                    if (count && !strncmp(names[count-1], names[count], prefix) && names[count-1][prefix] == '[')
+                        group[count] = group[count-1];
+                    fields = ++count;
+                }
+            else if (!strncmp(line, "H Field I predictor:", 20))
+                for (; p < end && count < MAX_FIELDS; p += strcspn(p, ",\n") + 1)
+                    intraPredictor[count++] = atoi(p);
+            else if (!strncmp(line, "H Field I encoding:", 19))
+                for (; p < end && count < MAX_FIELDS; p += strcspn(p, ",\n") + 1)
+                    intraEncoding[count++] = atoi(p);
+            else if (!strncmp(line, "H Field P predictor:", 20))
+                for (; p < end && count < MAX_FIELDS; p += strcspn(p, ",\n") + 1)
+                    interPredictor[count++] = atoi(p);
+            pos += end - line + 1;
+        }
+
+        else if ((marker == 'I' || (marker == 'P' && inLog)) && fields >= 2) {
+            int start = pos++;
+            for (int k=0; k<fields; ++k) {
+                uint32_t raw = getVarint(log, pos);
+                uint32_t residual = marker == 'I' && intraEncoding[k] ? raw : (raw >> 1) ^ -(raw & 1);
+                uint32_t prediction = 0;
+                switch (marker == 'I' ? intraPredictor[k] : interPredictor[k]) {
+                    case 1: prediction = previous[k]; break;
+                    case 2: prediction = 2 * previous[k] - beforePrevious[k]; break;
+                    case 3: prediction = ((int32_t)previous[k] + (int32_t)beforePrevious[k]) / 2; break;
+                    case 4: prediction = values[group[k]]; break;
+                    case 5: prediction = 1000; break;
+                }
+                values[k] = prediction + residual;
+            }
+            // a frame cut off by the end of the flash
+            if (pos > (int)size)
+                break;
+            if (inLog) {
+                missing += (values[0] - previous[0]) / divisor - 1;
+                seconds += (values[1] - previous[1]) * 1e-6;
+            }
+            for (int k=0; k<fields; ++k) {
+                beforePrevious[k] = marker == 'I' ? values[k] : previous[k];
+                previous[k] = values[k];
+            }
+            inLog = true;
+            frames[marker == 'P']++;
+            frameBytes += pos - start;
+        }
+
+        else if (marker == 'E') {
+            inLog = false;
+            pos++;
+        }
+
+        else {
+            printf("Bad blackbox frame at byte %d\n", pos);
+            return;
+        }
+    }
+
+    int count = frames[0] + frames[1];
+
+    printf("Blackbox: %d logs, %d frames (%d intra) of %d fields (%d missing) over %.1f sec in %u bytes\n",
+            logs, count, frames[0], fields, missing, seconds, size);
+    printf("Blackbox: %.1f bytes per frame, against %d raw\n",
+            count ? (double)frameBytes / count : 0., 1 + 4 + 4 + 2 * (fields - 2));
+}
+
+// Accuracy and speed of the fastmath kernels against libm, over the argument ranges the firmware uses
+
+typedef float (*mathFunction_t)(float a, float b);
+
+static float libSin(float a, float)      { return sinf(a); }
+static float libCos(float a, float)      { return cosf(a); }
+static float libAtan2(float a, float b)  { return atan2f(a, b); }
+static float libInvSqrt(float a, float)  { return 1.0f / sqrtf(a); }
+static float libSqrt(float a, float)     { return sqrtf(a); }
+static float libPow(float a, float b)    { return powf(a, b); }
+static float fastSin2(float a, float)    { return fastSin(a); }
+static float fastCos2(float a, float)    { return fastCos(a); }
+static float fastInvSqrt2(float a, float){ return fastInvSqrt(a); }
+static float fastSqrt2(float a, float)   { return fastSqrt(a); }
+
+typedef struct {
+    const char *   name;
+    mathFunction_t libm;
+    mathFunction_t fast;
+    float          amin, amax;      // first argument swept over [amin,amax]
+    float          bmin, bmax;      // second argument likewise
+    bool           relative;        // report relative rather than absolute error
+} mathKernel_t;
+
+static const mathKernel_t MATH_KERNELS[] = {
+    {"sin",     libSin,     fastSin2,     -10, 10, 0, 0, false},
+    {"cos",     libCos,     fastCos2,     -10, 10, 0, 0, false},
+    {"atan2",   libAtan2,   fastAtan2,    -1,  1,  -1, 1, false},
+    {"invsqrt", libInvSqrt, fastInvSqrt2, 1e-3f, 1e8f, 0, 0, true},
+    {"sqrt",    libSqrt,    fastSqrt2,    1e-3f, 1e8f, 0, 0, true},
+    {"pow",     libPow,     fastPow,      0.3f, 1.1f, 0.190295f, 0.190295f, true}, // baro pressure ratio
+};
+
+static const int MATH_SAMPLES = 1000000;
+
+static double mathNanoseconds(mathFunction_t f, const float * a, const float * b)
+{
+    volatile float sink = 0;
+    double start = wallSeconds();
+    for (int k=0; k<MATH_SAMPLES; ++k)
+        sink = sink + f(a[k], b[k]);
+    return (wallSeconds() - start) * 1e9 / MATH_SAMPLES;
+}
+
+static void reportMath(void)
+{
+    float * a = new float[MATH_SAMPLES];
+    float * b = new float[MATH_SAMPLES];
+
+    printf("Function  max error      type      libm nsec  fast nsec\n");
+
+    for (unsigned int j=0; j<sizeof(MATH_KERNELS)/sizeof(MATH_KERNELS[0]); ++j) {
+
+        const mathKernel_t * m = &MATH_KERNELS[j];
+
+        // a sweeps its range; b, when it varies, sweeps against it at a different rate
+        double maxError = 0;
+        for (int k=0; k<MATH_SAMPLES; ++k) {
+            float u = (float)k / (MATH_SAMPLES - 1);
+            a[k] = m->relative ? m->amin * powf(m->amax / m->amin, u) : m->amin + (m->amax - m->amin) * u;
+            b[k] = m->bmin + (m->bmax - m->bmin) * fmodf(u * 997, 1);
+            double exact = m->libm(a[k], b[k]);
+            double error = fabs(m->fast(a[k], b[k]) - exact);
+            if (m->relative)
+                error /= fabs(exact);
+            if (error > maxError)
+                maxError = error;
+        }
+
+        printf("%-8s  %10.2e  %-8s  %9.1f  %9.1f\n", m->name, maxError, m->relative ? "relative" : "absolute",
+                mathNanoseconds(m->libm, a, b), mathNanoseconds(m->fast, a, b));
+    }
+
+    delete[] a;
+    delete[] b;
+}
+
+static void usage(const char * name)
+{
+    fprintf(stderr, "Usage:   %s [-a] [-b FILE] [-d SECONDS] [-l] [-p] [-s SEED] [-t] [-v] [-m]\n", name);
+    fprintf(stderr, "  -a   arm in autotune mode and report the tuned gains at the end of the run\n");
+    fprintf(stderr, "  -b   save the blackbox log to FILE and report what it holds\n");
+    fprintf(stderr, "  -d   simulated duration (default %.0f)\n", DEFAULT_DURATION_SEC);
+    fprintf(stderr, "  -l   report pushed telemetry against polling at the end of the run\n");
+    fprintf(stderr, "  -m   report fastmath accuracy against libm, then exit\n");
+    fprintf(stderr, "  -p   no IMU data-ready interrupt: the firmware's sample task reads the sensor\n");
+    fprintf(stderr, "  -s   sensor-noise seed (default 1)\n");
+    fprintf(stderr, "  -t   report loop and task timing at the end of the run\n");
+    fprintf(stderr, "  -v   print a trace every %.1f simulated seconds\n", TRACE_PERIOD_SEC);
+    fprintf(stderr, "Example: %s -d 3600\n", name);
+    exit(1);
+}
+
+int main(int argc, char ** argv)
+{
+    float    durationSec = DEFAULT_DURATION_SEC;
+    uint32_t seed = 1;
+    bool     verbose = false;
+    bool     timing = false;
+    bool     autotune = false;
+    bool     telemetry = false;
+    char *   blackboxFile = NULL;
+    bool     imuInterrupt = true;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "ab:d:lmps:tv")) != -1) {
+        switch (opt) {
+            case 'a':
+                autotune = true;
+                break;
+            case 'b':
+                blackboxFile = optarg;
+                break;
+            case 'd':
+                durationSec = atof(optarg);
+                break;
+            case 'l':
+                telemetry = true;
+                break;
+            case 'm':
+                reportMath();
+                return 0;
+            case 'p':
+                imuInterrupt = false;
+                break;
+            case 's':
+                seed = (uint32_t)atol(optarg);
+                break;
+            case 't':
+                timing = true;
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    silInit(seed, imuInterrupt);
+
+    double wallStart = wallSeconds();
+
+    setup();
+
+    uint64_t durationUsec = (uint64_t)(durationSec * 1e6);
+    uint64_t elapsedUsec = silMicros();
+    uint64_t nextTraceUsec = elapsedUsec;
+    uint64_t loops = 0;
+
+    float maxTilt = 0;
+    float maxAltitude = 0;
+    bool  everArmed = false;
+
+    QuadModel & model = silModel();
+
+    while (elapsedUsec < durationUsec) {
+
+        float t = elapsedUsec * 1e-6f;
+
+        float demands[5];
+        getDemands(t, autotune, demands);
+        silSetDemands(demands);
+
+        silStep(SIL_TICK_USEC);
+        elapsedUsec += SIL_TICK_USEC;
+
+        loop();
+        loops++;
+
+        float angles[3];
+        model.getAttitude(angles);
+
+        float tilt = fmaxf(fabsf(angles[0]), fabsf(angles[1]));
+        if (tilt > maxTilt)
+            maxTilt = tilt;
+        if (model.getAltitude() > maxAltitude)
+            maxAltitude = model.getAltitude();
+        everArmed = everArmed || silArmed();
+
+        if (verbose && elapsedUsec >= nextTraceUsec) {
+            printf("%8.3f  %s  roll: %+7.2f  pitch: %+7.2f  yaw: %+7.2f  alt: %6.2f  rpm: %5.0f %5.0f %5.0f %5.0f\n",
+                    t, silArmed() ? "ARMED" : "     ", angles[0], angles[1], angles[2], model.getAltitude(),
+                    model.rpm[0], model.rpm[1], model.rpm[2], model.rpm[3]);
+            nextTraceUsec += (uint64_t)(TRACE_PERIOD_SEC * 1e6);
+        }
+    }
+
+    double wallElapsed = wallSeconds() - wallStart;
+    double simElapsed  = elapsedUsec * 1e-6;
+
+    printf("Armed: %s  Max tilt: %.1f deg  Max altitude: %.2f m  Landed: %s\n",
+            everArmed ? "yes" : "no", maxTilt, maxAltitude, model.landed() ? "yes" : "no");
+    printf("Simulated %.1f sec (%llu loops) in %.3f sec: %.1f simulated sec/sec\n",
+            simElapsed, (unsigned long long)loops, wallElapsed, simElapsed / wallElapsed);
+
+    if (timing)
+        reportTiming();
+
+    if (autotune)
+        reportAutotune();
+
+    if (telemetry) {
+        reportTelemetry(false);
+        reportTelemetry(true);
+    }
+
+    if (blackboxFile)
+        reportBlackbox(blackboxFile);
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*
+   model.cpp : Rigid-body quadcopter model for software-in-the-loop simulation
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "model.hpp"
+
+static const float GRAVITY = 9.80665f;
+
+// Motor order follows the firmware mixer: REAR_R, FRONT_R, REAR_L, FRONT_L.
+// Positions are (forward, left) in units of arm length / sqrt(2).
+static const float MOTOR_X[4]    = { -1, +1, -1, +1 };
+static const float MOTOR_Y[4]    = { -1, -1, +1, +1 };
+
+// +1 for clockwise props, whose reaction torque yaws the body nose-left
+static const float MOTOR_SPIN[4] = { +1, -1, -1, +1 };
+
+void QuadModel::init(uint32_t seed)
+{
+    memset(this->position, 0, sizeof(this->position));
+    memset(this->velocity, 0, sizeof(this->velocity));
+    memset(this->gyro, 0, sizeof(this->gyro));
+    memset(this->motorCommand, 0, sizeof(this->motorCommand));
+    memset(this->motorPhase, 0, sizeof(this->motorPhase));
+    memset(this->rpm, 0, sizeof(this->rpm));
+
+    this->quat[0] = 1;
+    this->quat[1] = 0;
+    this->quat[2] = 0;
+    this->quat[3] = 0;
+
+    this->specificForce[0] = 0;
+    this->specificForce[1] = 0;
+    this->specificForce[2] = GRAVITY;
+
+    this->noiseState = seed ? seed : 1;
+}
+
+// Deterministic xorshift noise, so that runs are repeatable across platforms
+float QuadModel::noise(void)
+{
+    float sum = 0;
+
+    for (uint8_t k=0; k<2; ++k) {
+        this->noiseState ^= this->noiseState << 13;
+        this->noiseState ^= this->noiseState >> 17;
+        this->noiseState ^= this->noiseState << 5;
+        sum += (float)this->noiseState / 4294967295.0f - 0.5f;
+    }
+
+    return sum; // triangular on [-1,+1]
+}
+
+void QuadModel::rotate(const float v[3], float out[3], bool toWorld)
+{
+    float w = this->quat[0];
+    float x = this->quat[1];
+    float y = this->quat[2];
+    float z = this->quat[3];
+
+    float r[3][3] = {
+        { 1 - 2*(y*y + z*z), 2*(x*y - w*z),     2*(x*z + w*y)     },
+        { 2*(x*y + w*z),     1 - 2*(x*x + z*z), 2*(y*z - w*x)     },
+        { 2*(x*z - w*y),     2*(y*z + w*x),     1 - 2*(x*x + y*y) }
+    };
+
+    for (uint8_t i=0; i<3; ++i)
+        out[i] = toWorld ?
+            r[i][0]*v[0] + r[i][1]*v[1] + r[i][2]*v[2] :
+            r[0][i]*v[0] + r[1][i]*v[1] + r[2][i]*v[2];
+}
+
+void QuadModel::setMotor(uint8_t index, float command)
+{
+    this->motorCommand[index] = command < 0 ? 0 : (command > 1 ? 1 : command);
+}
+
+void QuadModel::update(float dt)
+{
+    float thrust = 0;
+    float torque[3] = {0, 0, 0};
+    float d = MODEL_ARM_M / sqrtf(2);
+
+    for (uint8_t i=0; i<4; ++i) {
+
+        // First-order spin-up toward commanded speed
+        float target = this->motorCommand[i] * MODEL_MAX_RPM;
+        this->rpm[i] += (target - this->rpm[i]) * dt / (MODEL_MOTOR_TAU_SEC + dt);
+        this->motorPhase[i] = fmodf(this->motorPhase[i] + this->rpm[i] / 60 * 2 * (float)M_PI * dt, 2 * (float)M_PI);
+
+        float n = this->rpm[i] / MODEL_MAX_RPM;
+        float t = MODEL_MAX_THRUST_N * n * n;
+
+        thrust    += t;
+        torque[0] += MOTOR_Y[i] * d * t;
+        torque[1] -= MOTOR_X[i] * d * t;
+        torque[2] += MOTOR_SPIN[i] * MODEL_YAW_TORQUE_M * t;
+    }
+
+    // Rotational dynamics: Euler's equations with a little aerodynamic damping
+    float * w = this->gyro;
+    float wdot[3];
+    wdot[0] = (torque[0] - (MODEL_IZZ - MODEL_IYY) * w[1] * w[2] - MODEL_ANGULAR_DRAG * w[0]) / MODEL_IXX;
+    wdot[1] = (torque[1] - (MODEL_IXX - MODEL_IZZ) * w[2] * w[0] - MODEL_ANGULAR_DRAG * w[1]) / MODEL_IYY;
+    wdot[2] = (torque[2] - (MODEL_IYY - MODEL_IXX) * w[0] * w[1] - MODEL_ANGULAR_DRAG * w[2]) / MODEL_IZZ;
+    for (uint8_t k=0; k<3; ++k)
+        w[k] += wdot[k] * dt;
+
+    // Integrate attitude quaternion: qdot = q * (0,w) / 2
+    float * q = this->quat;
+    float qdot[4] = {
+        0.5f * (-q[1]*w[0] - q[2]*w[1] - q[3]*w[2]),
+        0.5f * ( q[0]*w[0] + q[2]*w[2] - q[3]*w[1]),
+        0.5f * ( q[0]*w[1] - q[1]*w[2] + q[3]*w[0]),
+        0.5f * ( q[0]*w[2] + q[1]*w[1] - q[2]*w[0])
+    };
+    float norm = 0;
+    for (uint8_t k=0; k<4; ++k) {
+        q[k] += qdot[k] * dt;
+        norm += q[k] * q[k];
+    }
+    norm = sqrtf(norm);
+    for (uint8_t k=0; k<4; ++k)
+        q[k] /= norm;
+
+    // Translational dynamics in world frame
+    float thrustBody[3] = {0, 0, thrust};
+    float thrustWorld[3];
+    this->rotate(thrustBody, thrustWorld, true);
+
+    float accel[3];
+    for (uint8_t k=0; k<3; ++k) {
+        accel[k] = (thrustWorld[k] - MODEL_LINEAR_DRAG * this->velocity[k]) / MODEL_MASS_KG;
+    }
+    accel[2] -= GRAVITY;
+
+    for (uint8_t k=0; k<3; ++k) {
+        this->velocity[k] += accel[k] * dt;
+        this->position[k] += this->velocity[k] * dt;
+    }
+
+    // Ground contact: come to rest upright, keeping heading
+    if (this->position[2] <= 0) {
+
+        this->position[2] = 0;
+
+        for (uint8_t k=0; k<3; ++k) {
+            this->velocity[k] = 0;
+            this->gyro[k] = 0;
+            accel[k] = 0;
+        }
+
+        float yaw = 2 * atan2f(q[3], q[0]);
+        q[0] = cosf(yaw/2);
+        q[1] = 0;
+        q[2] = 0;
+        q[3] = sinf(yaw/2);
+    }
+
+    // Accelerometer measures everything but gravity
+    float specificWorld[3] = {accel[0], accel[1], accel[2] + GRAVITY};
+    this->rotate(specificWorld, this->specificForce, false);
+}
+
+void QuadModel::readIMU(int16_t accADC[3], int16_t gyroADC[3])
+{
+    float vibration[3] = {0, 0, 0};
+
+    for (uint8_t i=0; i<4; ++i) {
+        float n = this->rpm[i] / MODEL_MAX_RPM;
+        vibration[0] += MODEL_VIBRATION_RADPS * n * n * sinf(this->motorPhase[i]);
+        vibration[1] += MODEL_VIBRATION_RADPS * n * n * cosf(this->motorPhase[i]);
+    }
+
+    float gyroLSB = MODEL_GYRO_LSB_PER_DPS * 180 / (float)M_PI;
+
+    for (uint8_t k=0; k<3; ++k) {
+
+        float a = (this->specificForce[k] + MODEL_ACCEL_NOISE_MPS2 * this->noise()) / GRAVITY * MODEL_ACC_1G;
+        float g = (this->gyro[k] + vibration[k] + MODEL_GYRO_NOISE_RADPS * this->noise()) * gyroLSB;
+
+        accADC[k]  = (int16_t)(a > 32767 ? 32767 : (a < -32768 ? -32768 : a));
+        gyroADC[k] = (int16_t)(g > 32767 ? 32767 : (g < -32768 ? -32768 : g));
+    }
+}
+
+void QuadModel::getAttitude(float angles[3])
+{
+    float up[3] = {0, 0, 1};
+    float upBody[3];
+    this->rotate(up, upBody, false);
+
+    float forward[3] = {1, 0, 0};
+    float forwardWorld[3];
+    this->rotate(forward, forwardWorld, true);
+
+    angles[0] = atan2f(upBody[1], upBody[2]) * 180 / (float)M_PI;
+    angles[1] = atan2f(-upBody[0], sqrtf(upBody[1]*upBody[1] + upBody[2]*upBody[2])) * 180 / (float)M_PI;
+    angles[2] = atan2f(forwardWorld[1], forwardWorld[0]) * 180 / (float)M_PI;
+}
+
+float QuadModel::getAltitude(void)
+{
+    return this->position[2];
+}
+
+bool QuadModel::landed(void)
+{
+    return this->position[2] <= 0;
+}
@@ -0,0 +1,83 @@
+/*
+   model.hpp : Rigid-body quadcopter model for software-in-the-loop simulation
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Airframe constants, roughly a 250mm brushless quad
+#define MODEL_MASS_KG              0.50f
+#define MODEL_ARM_M                0.125f
+#define MODEL_IXX                  0.0030f
+#define MODEL_IYY                  0.0030f
+#define MODEL_IZZ                  0.0055f
+#define MODEL_MAX_THRUST_N         4.0f     // per motor
+#define MODEL_MAX_RPM              30000.0f
+#define MODEL_MOTOR_TAU_SEC        0.020f   // first-order motor spin-up time constant
+#define MODEL_YAW_TORQUE_M         0.016f   // reaction torque per newton of thrust
+#define MODEL_LINEAR_DRAG          0.25f
+#define MODEL_ANGULAR_DRAG         0.0008f
+
+// Sensor imperfections
+#define MODEL_GYRO_NOISE_RADPS     0.005f
+#define MODEL_ACCEL_NOISE_MPS2     0.05f
+#define MODEL_VIBRATION_RADPS      0.04f    // gyro vibration per motor at full speed
+
+// Mimic MPU6050 / MPU9250 at +/-8g, +/-2000 deg/sec
+#define MODEL_ACC_1G               4096
+#define MODEL_GYRO_LSB_PER_DPS     16.4f
+
+class QuadModel {
+
+    private:
+
+        // World frame is East-North-Up; body frame is Forward-Left-Up, so that
+        // positive roll, pitch, yaw are right-side-down, nose-down, nose-left,
+        // matching the firmware's sensor conventions.
+        float position[3];
+        float velocity[3];
+        float quat[4];          // body-to-world rotation, w,x,y,z
+        float gyro[3];          // body angular velocity, rad/sec
+        float specificForce[3]; // body-frame accelerometer reading, m/s^2
+
+        float motorCommand[4];  // [0,1]
+        float motorPhase[4];    // radians, for vibration
+        uint32_t noiseState;
+
+        float noise(void);
+        void  rotate(const float v[3], float out[3], bool toWorld);
+
+    public:
+
+        // Per-motor shaft speed, available to telemetry-capable boards
+        float rpm[4];
+
+        void init(uint32_t seed);
+
+        void setMotor(uint8_t index, float command);
+
+        void update(float dt);
+
+        void readIMU(int16_t accADC[3], int16_t gyroADC[3]);
+
+        // Euler angles in degrees (roll, pitch, yaw) using firmware sign conventions
+        void getAttitude(float angles[3]);
+
+        float getAltitude(void);
+
+        bool landed(void);
+};
@@ -0,0 +1,41 @@
+/*
+   sil.hpp : Declarations shared between the software-in-the-loop runner and its Board implementation
+
+   This file is part of Hackflight.
+
+   Hackflight is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+   Hackflight is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License
+   along with Hackflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "model.hpp"
+
+// Physics step; the firmware sees time advance in these increments
+#define SIL_TICK_USEC 500
+
+// Implemented in board.cpp
+// imuInterrupt = false leaves the ring to the firmware's sample task, as on the flight boards
+void       silInit(uint32_t seed, bool imuInterrupt);
+void       silStep(uint32_t usec);
+uint32_t   silMicros(void);
+void       silSetDemands(const float demands[5]);
+bool       silArmed(void);
+QuadModel & silModel(void);
+
+// Serial link to the firmware's MSP parser
+void       silSerialWrite(const uint8_t * buf, uint16_t len);
+uint16_t   silSerialRead(uint8_t * buf, uint16_t maxlen);
+
+// What the firmware's blackbox has written to the simulated flash
+uint32_t   silBlackbox(const uint8_t ** data);
@@ -138,9 +138,9 @@ class CompanionBoard {
             }
         }
 
-        void sendByte(uint8_t b)
+        void sendBytes(const uint8_t * data, uint16_t count)
         {
-            this->commsOutSocket.send((char *)&b, 1);
+            this->commsOutSocket.send((char *)data, count);
         }
 
         void halt(void)
@@ -194,20 +194,22 @@ void extrasStop(void)
     companionBoard.halt();
 }
 
-uint8_t Board::serialAvailableBytes(void)
+uint16_t Board::serialRead(uint8_t * data, uint16_t maxCount)
 {
-    return mspFromServerLen;
-}
+    uint16_t count = mspFromServerLen < maxCount ? mspFromServerLen : maxCount;
 
-uint8_t Board::serialReadByte(void)
-{
-    mspFromServerLen--;
-    return mspFromServer[mspFromServerIndex++];
+    memcpy(data, &mspFromServer[mspFromServerIndex], count);
+    mspFromServerIndex += count;
+    mspFromServerLen -= count;
+
+    return count;
 }
 
-void Board::serialWriteByte(uint8_t c)
+uint16_t Board::serialWrite(const uint8_t * data, uint16_t count)
 {
-    companionBoard.sendByte(c);
+    companionBoard.sendBytes(data, count);
+
+    return count;
 }
 
 bool Board::sonarInit(uint8_t index) 
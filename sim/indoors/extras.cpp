@@ -82,24 +82,27 @@ void extrasStop(void)
         serialConnection.closeConnection();
 }
 
-uint8_t Board::serialAvailableBytes(void)
+uint16_t Board::serialRead(uint8_t * data, uint16_t maxCount)
 {
-    return serialConnected ? serialConnection.bytesAvailable() : 0;
-}
+    if (!serialConnected)
+        return 0;
 
-uint8_t Board::serialReadByte(void)
-{
-    uint8_t c = 0;
-    if (serialConnected)
-        serialConnection.readBytes((char *)&c, 1);
-    return c;
+    int available = serialConnection.bytesAvailable();
+    uint16_t count = available < maxCount ? available : maxCount;
+
+    if (count)
+        serialConnection.readBytes((char *)data, count);
+
+    return count;
 }
 
-void Board::serialWriteByte(uint8_t c)
+uint16_t Board::serialWrite(const uint8_t * data, uint16_t count)
 {
     if (serialConnected)
-        serialConnection.writeBytes((char *)&c, 1);
-}            
+        serialConnection.writeBytes((char *)data, count);
+
+    return count;
+}
 
 bool Board::sonarInit(uint8_t index) 
 {
@@ -37,18 +37,14 @@ void extrasStop(void)
 {
 }
 
-uint8_t Board::serialAvailableBytes(void)
+uint16_t Board::serialRead(uint8_t * data, uint16_t maxCount)
 {
     return 0;
 }
 
-uint8_t Board::serialReadByte(void)
-{
-    return 0;
-}
-
-void Board::serialWriteByte(uint8_t c)
+uint16_t Board::serialWrite(const uint8_t * data, uint16_t count)
 {
+    return count;
 }
 
 bool Board::sonarInit(uint8_t index) 
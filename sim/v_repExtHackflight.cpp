@@ -574,6 +574,13 @@ void Board::imuRead(int16_t accADC[3], int16_t gyroADC[3])
     gyroADC[2] = -(int16_t)(1000 * gyro[2]);
 }
 
+bool Board::imuStartInterrupt(class ImuRing * ring)
+{
+    // V-REP steps the IMU once per loop(), so there is nothing to gain
+    (void)ring;
+    return false;
+}
+
 void Board::init(uint32_t & looptimeMicroseconds, uint32_t & calibratingGyroMsec)
 {
     looptimeMicroseconds = 10000;
@@ -589,6 +596,23 @@ void Board::ledSetState(uint8_t id, bool state)
 }
 
 
+bool Board::blackboxInit(void)
+{
+    return false;
+}
+
+uint16_t Board::blackboxWrite(const uint8_t * data, uint16_t count)
+{
+    (void)data;
+    (void)count;
+    return 0;
+}
+
+uint16_t Board::batteryMillivolts(void)
+{
+    return 0;
+}
+
 bool Board::baroInit(void)
 {
     return true;
@@ -605,7 +629,17 @@ int32_t Board::baroGetPressure(void)
 
 uint32_t Board::getMicros()
 {
-    return micros; 
+    return micros;
+}
+
+uint32_t Board::getTicks(void)
+{
+    return micros;
+}
+
+uint32_t Board::getTicksPerMicrosecond(void)
+{
+    return 1;
 }
 
 bool Board::rcUseSerial(void)
@@ -643,6 +677,22 @@ void Board::writeMotor(uint8_t index, uint16_t value)
     thrusts[index] = ((float)value - CONFIG_PWM_MIN) / (CONFIG_PWM_MAX - CONFIG_PWM_MIN);
 }
 
+uint8_t Board::motorCount(void)
+{
+    return 4;
+}
+
+void Board::completeMotorUpdate(void)
+{
+}
+
+bool Board::motorRpm(uint8_t index, uint16_t & rpm)
+{
+    (void)index;
+    (void)rpm;
+    return false;
+}
+
 void Board::showArmedStatus(bool armed)
 {
     if (armed) 
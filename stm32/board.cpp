@@ -32,10 +32,75 @@ extern "C" {
 #include <math.h>
 
 #include "board.hpp"
+#include "dshot.hpp"
 #include "motorpwm.hpp"
 
+// motorpwm.hpp can set 150, 300 or 600 for DShot ESCs
+#ifndef MOTOR_DSHOT
+#define MOTOR_DSHOT             0
+#endif
+
 extern serialPort_t * Serial1;
 
+// Cortex-M3 DWT cycle counter, for profiling
+#define DEMCR           (*(volatile uint32_t *)0xE000EDFC)
+#define DEMCR_TRCENA    0x01000000
+#define DWT_CTRL        (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNTENA   0x00000001
+#define DWT_CYCCNT      (*(volatile uint32_t *)0xE0001004)
+
+#if MOTOR_DSHOT
+
+// Motors 1-6 with a PPM receiver: PA8 and PA11 on TIM1 channels 1 and 4, PB6-PB9 on TIM4 channels 1-4.
+// Once a bit period, each timer has DMA burst the next bit's four compare values into CCR1-CCR4;
+// they take effect at the following update, since pwmInit() enables compare preload.
+static const uint32_t DSHOT_BIT_TICKS = 72000000 / (MOTOR_DSHOT * 1000);
+
+typedef struct dshotTimer_t {
+    TIM_TypeDef         * tim;
+    DMA_Channel_TypeDef * dma;
+    uint16_t              request;
+    uint32_t              buffer[DSHOT_BUFFER_BITS * 4];
+} dshotTimer_t;
+
+// TIM1_UP shares DMA1 channel 5 with the UART receiver, so TIM1 bursts on its channel-1 compare
+static dshotTimer_t dshotTimers[2] = {
+    { TIM1, DMA1_Channel2, TIM_DIER_CC1DE },
+    { TIM4, DMA1_Channel7, TIM_DIER_UDE },
+};
+
+static const uint8_t DSHOT_TIMER[6]   = {0, 0, 1, 1, 1, 1};
+static const uint8_t DSHOT_CHANNEL[6] = {0, 3, 0, 1, 2, 3};
+
+static void dshotInit(void)
+{
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+    for (uint8_t k=0; k<2; ++k) {
+
+        TIM_TypeDef * tim = dshotTimers[k].tim;
+        DMA_Channel_TypeDef * dma = dshotTimers[k].dma;
+
+        // pwmInit() has set up the pins and PWM mode; run at the bit rate instead
+        tim->CR1 &= ~TIM_CR1_CEN;
+        tim->PSC = 0;
+        tim->ARR = DSHOT_BIT_TICKS - 1;
+        tim->CCR1 = tim->CCR2 = tim->CCR3 = tim->CCR4 = 0;
+        tim->EGR = TIM_EGR_UG;
+
+        // bursts of four transfers through DMAR, starting at CCR1
+        tim->DCR = (3 << 8) | (((uint32_t)&tim->CCR1 - (uint32_t)tim) / 4);
+        tim->DIER |= dshotTimers[k].request;
+
+        dma->CPAR = (uint32_t)&tim->DMAR;
+        dma->CCR = DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_MSIZE_1 | DMA_CCR1_PSIZE_0 | DMA_CCR1_PL_1;
+
+        tim->CR1 |= TIM_CR1_CEN;
+    }
+}
+
+#endif
+
 void Board::imuInit(uint16_t & acc1G, float & gyroScale)
 {
     acc1G = mpu6050_init(INV_FSR_8G, INV_FSR_2000DPS);
@@ -48,17 +113,73 @@ void Board::imuRead(int16_t accADC[3], int16_t gyroADC[3])
     mpu6050_read_gyro(gyroADC);
 }
 
+// BreezySTM32's I2C reads wait for their transfer to finish, and the MPU6050's data-ready
+// interrupt can't wait inside an ISR: a read there would hold off every lower-priority
+// interrupt for the whole transfer.  Until the driver can start a transfer and call back when
+// it completes, the IMU's sample task reads the sensor into the ring instead.
+bool Board::imuStartInterrupt(class ImuRing * ring)
+{
+    (void)ring;
+    return false;
+}
+
 void Board::init(uint32_t & looptimeMicroseconds, uint32_t & calibratingGyroMsec)
 {
     i2cInit(I2CDEV_2);
 
     pwmInit(USE_CPPM, PWM_FILTER, FAST_PWM, MOTOR_PWM_RATE, PWM_IDLE_PULSE);
 
+#if MOTOR_DSHOT
+    dshotInit();
+#endif
+
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CYCCNTENA;
+
     looptimeMicroseconds = Board::DEFAULT_IMU_LOOPTIME_USEC; 
 
     calibratingGyroMsec  = Board::DEFAULT_GYRO_CALIBRATION_MSEC;
 }
 
+// BreezySTM32 has no driver yet for the Naze32's SPI flash, so blackbox goes to a serial logger
+// (OpenLog or similar, set to the same baud rate) on USART2.  Its pins, PA2 and PA3, are PWM
+// inputs 3 and 4 without CPPM, and a Spektrum receiver's port (board_rx_dsm.cpp), so set this
+// to 0 when building with board_rx_dsm.cpp.
+#define BLACKBOX_UART           USE_CPPM
+static const uint32_t BLACKBOX_BAUD = 250000;
+
+static serialPort_t * blackboxPort;
+
+bool Board::blackboxInit(void)
+{
+    if (!BLACKBOX_UART)
+        return false;
+
+    blackboxPort = uartOpen(USART2, NULL, BLACKBOX_BAUD, MODE_TX);
+    return true;
+}
+
+uint16_t Board::blackboxWrite(const uint8_t * data, uint16_t count)
+{
+    // take only what fits in the driver's transmit ring, as serialWrite() does
+    uint32_t used = (blackboxPort->txBufferHead + blackboxPort->txBufferSize - blackboxPort->txBufferTail) % blackboxPort->txBufferSize;
+    uint32_t room = blackboxPort->txBufferSize - 1 - used;
+
+    if (count > room)
+        count = room;
+
+    for (uint16_t k=0; k<count; ++k)
+        ::serialWrite(blackboxPort, data[k]);
+
+    return count;
+}
+
+uint16_t Board::batteryMillivolts(void)
+{
+    return 0;
+}
+
 bool Board::baroInit(void)
 {
     return false;
@@ -83,6 +204,16 @@ uint32_t Board::getMicros()
     return micros();
 }
 
+uint32_t Board::getTicks(void)
+{
+    return DWT_CYCCNT;
+}
+
+uint32_t Board::getTicksPerMicrosecond(void)
+{
+    return SystemCoreClock / 1000000;
+}
+
 void Board::ledSetState(uint8_t id, bool state)
 {
     GPIO_TypeDef * gpio = id ? LED1_GPIO : LED0_GPIO;
@@ -101,31 +232,78 @@ void Board::reboot(void)
     systemResetToBootloader();
 }
 
-uint8_t Board::serialAvailableBytes(void)
+uint16_t Board::serialRead(uint8_t * data, uint16_t maxCount)
 {
-    return serialTotalRxBytesWaiting(Serial1);
-}
+    uint16_t count = 0;
 
-uint8_t Board::serialReadByte(void)
-{
-    return serialRead(Serial1);
+    while (count < maxCount && serialTotalRxBytesWaiting(Serial1))
+        data[count++] = ::serialRead(Serial1);
+
+    return count;
 }
 
-void Board::serialWriteByte(uint8_t c)
+uint16_t Board::serialWrite(const uint8_t * data, uint16_t count)
 {
-    serialWrite(Serial1, c);
-    while (!isSerialTransmitBufferEmpty(Serial1));
+    // the UART driver drains its transmit ring by DMA, so only room in the ring is needed
+    uint32_t used = (Serial1->txBufferHead + Serial1->txBufferSize - Serial1->txBufferTail) % Serial1->txBufferSize;
+    uint32_t room = Serial1->txBufferSize - 1 - used;
+
+    if (count > room)
+        count = room;
+
+    for (uint16_t k=0; k<count; ++k)
+        ::serialWrite(Serial1, data[k]);
+
+    return count;
 }
 
 void Board::serialDebugByte(uint8_t c)
 {
-    serialWrite(Serial1, c);
+    ::serialWrite(Serial1, c);
     while (!isSerialTransmitBufferEmpty(Serial1));
 }
 
 void Board::writeMotor(uint8_t index, uint16_t value)
 {
+#if MOTOR_DSHOT
+    dshotTimer_t * timer = &dshotTimers[DSHOT_TIMER[index]];
+    dshotBits(dshotFrame(dshotThrottle(value), false, false), 
+            DSHOT_BIT_TICKS * 3 / 8, DSHOT_BIT_TICKS * 3 / 4, &timer->buffer[DSHOT_CHANNEL[index]], 4);
+#else
     pwmWriteMotor(index, value);
+#endif
+}
+
+void Board::completeMotorUpdate(void)
+{
+#if MOTOR_DSHOT
+    for (uint8_t k=0; k<2; ++k) {
+        DMA_Channel_TypeDef * dma = dshotTimers[k].dma;
+        dma->CCR &= ~DMA_CCR1_EN;
+        dma->CMAR = (uint32_t)dshotTimers[k].buffer;
+        dma->CNDTR = DSHOT_BUFFER_BITS * 4;
+        dma->CCR |= DMA_CCR1_EN;
+    }
+#endif
+}
+
+uint8_t Board::motorCount(void)
+{
+#if MOTOR_DSHOT
+    return 6;
+#else
+    // a parallel-PWM receiver takes the timers that would drive motors 7 and 8
+    return USE_CPPM ? 8 : 6;
+#endif
+}
+
+// Bidirectional DShot would need each pin turned around to capture the ESC's reply, and
+// the DMA channels for that are taken by the UART and the output bursts
+bool Board::motorRpm(uint8_t index, uint16_t & rpm)
+{
+    (void)index;
+    (void)rpm;
+    return false;
 }
 
 bool Board::sonarInit(uint8_t index) 
@@ -0,0 +1 @@
+../../firmware/autotune.cpp
\ No newline at end of file
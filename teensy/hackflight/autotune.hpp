@@ -0,0 +1 @@
+../../firmware/autotune.hpp
\ No newline at end of file
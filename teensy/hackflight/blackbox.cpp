@@ -0,0 +1 @@
+../../firmware/blackbox.cpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../firmware/blackbox.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../firmware/blackboxencoder.cpp
\ No newline at end of file
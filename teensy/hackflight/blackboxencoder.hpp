@@ -0,0 +1 @@
+../../firmware/blackboxencoder.hpp
\ No newline at end of file
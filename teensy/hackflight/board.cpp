@@ -41,6 +41,7 @@ static SpektrumDSM2048 rx;
 
 #include "board.hpp"
 #include "rc.hpp"
+#include "dshot.hpp"
 
 // an MPU9250 object with its I2C address 
 // of 0x68 (ADDR to GRND) and on Teensy bus 0
@@ -55,6 +56,46 @@ MPU9250 imu(0x68, 0, I2C_PINS_16_17, I2C_PULLUP_INT);
 // Multiwii M4 = Controller M4 = Pin 22
 static const uint8_t MOTOR_PINS[4] = {23, 3, 4, 22};
 
+// 150, 300 or 600 to drive DShot ESCs from the same pins instead of the brushed-motor board
+#define MOTOR_DSHOT 0
+
+#if MOTOR_DSHOT
+#include <DMAChannel.h>
+
+// FlexTimer channel behind each motor pin: each compare match requests DMA of the next bit's duty
+static volatile uint32_t * const DSHOT_CV[4]  = {&FTM0_C1V,  &FTM1_C0V,  &FTM1_C1V,  &FTM0_C0V};
+static volatile uint32_t * const DSHOT_CSC[4] = {&FTM0_C1SC, &FTM1_C0SC, &FTM1_C1SC, &FTM0_C0SC};
+static const uint8_t DSHOT_DMA_SOURCE[4] = {
+    DMAMUX_SOURCE_FTM0_CH1, DMAMUX_SOURCE_FTM1_CH0, DMAMUX_SOURCE_FTM1_CH1, DMAMUX_SOURCE_FTM0_CH0};
+
+// pin mux alternative that routes each pin to its FlexTimer channel (PTC2, PTA12, PTA13, PTC1)
+static const uint8_t DSHOT_PIN_MUX[4] = {4, 3, 3, 4};
+
+static const uint32_t DSHOT_BIT_TICKS = F_BUS / (MOTOR_DSHOT * 1000);
+
+static DMAChannel dshotDma[4];
+static uint32_t   dshotBuffer[4][DSHOT_BUFFER_BITS];
+
+static void dshotInit(void)
+{
+  for (int k=0; k<4; ++k) {
+
+    // one PWM period per bit
+    analogWriteFrequency(MOTOR_PINS[k], MOTOR_DSHOT * 1000);
+
+    // analogWrite(pin, 0) just drives the pin low as a GPIO, so route it to the timer ourselves:
+    // edge-aligned, high-true PWM with zero duty until the first frame
+    *DSHOT_CV[k] = 0;
+    *DSHOT_CSC[k] = FTM_CSC_MSB | FTM_CSC_ELSB | FTM_CSC_CHIE | FTM_CSC_DMA;
+    *portConfigRegister(MOTOR_PINS[k]) = PORT_PCR_MUX(DSHOT_PIN_MUX[k]) | PORT_PCR_DSE | PORT_PCR_SRE;
+
+    dshotDma[k].destination(*DSHOT_CV[k]);
+    dshotDma[k].triggerAtHardwareEvent(DSHOT_DMA_SOURCE[k]);
+    dshotDma[k].disableOnCompletion();
+  }
+}
+#endif
+
 void Board::imuInit(uint16_t & acc1G, float & gyroScale)
 {
     // wake up device
@@ -67,16 +108,33 @@ void Board::imuInit(uint16_t & acc1G, float & gyroScale)
     gyroScale = (1.0f / 16.4f) * (M_PI / 180.0f);
 }
 
+// The MPU9250 library's reads block until their I2C transfer completes, which can't happen in
+// the data-ready interrupt without stalling everything below it for the whole transfer, so the
+// IMU's sample task reads the sensor into the ring instead.
+bool Board::imuStartInterrupt(class ImuRing * ring)
+{
+    (void)ring;
+    return false;
+}
+
 void Board::init(uint32_t & looptimeMicroseconds, uint32_t & calibratingGyroMsec)
 {
     // Stop motors
+#if MOTOR_DSHOT
+    dshotInit();
+#else
     for (int k=0; k<4; ++k) {
       analogWrite(MOTOR_PINS[k], 0);
     }
+#endif
   
     // Set up LED
     pinMode(13, OUTPUT);
 
+    // Start cycle counter for profiling
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
     // Start receiver
     rx.begin();
 
@@ -110,6 +168,16 @@ uint32_t Board::getMicros()
     return micros();
 }
 
+uint32_t Board::getTicks(void)
+{
+    return ARM_DWT_CYCCNT;
+}
+
+uint32_t Board::getTicksPerMicrosecond(void)
+{
+    return F_CPU / 1000000;
+}
+
 void Board::ledSetState(uint8_t id, bool state)
 {
     digitalWrite(13, state); // we only have one LED
@@ -140,19 +208,43 @@ uint16_t Board::rcReadSerial(uint8_t chan)
 }
 
 
-uint8_t Board::serialAvailableBytes(void)
+uint16_t Board::serialRead(uint8_t * data, uint16_t maxCount)
+{
+    int available = Serial.available();
+    uint16_t count = available < maxCount ? available : maxCount;
+
+    // readBytes() would wait out its timeout for bytes that haven't arrived, so ask only for these
+    return count ? Serial.readBytes((char *)data, count) : 0;
+}
+
+uint16_t Board::serialWrite(const uint8_t * data, uint16_t count)
 {
-    return Serial.available();
+    int room = Serial.availableForWrite();
+
+    if (room < count)
+        count = room;
+
+    return count ? Serial.write(data, count) : 0;
 }
 
-uint8_t Board::serialReadByte(void)
+// Blackbox goes to a serial logger (OpenLog or similar, set to the same baud rate) on Serial2;
+// Serial1 is the receiver
+static const uint32_t BLACKBOX_BAUD = 921600;
+
+bool Board::blackboxInit(void)
 {
-    return Serial.read();
+    Serial2.begin(BLACKBOX_BAUD);
+    return true;
 }
 
-void Board::serialWriteByte(uint8_t c)
+uint16_t Board::blackboxWrite(const uint8_t * data, uint16_t count)
 {
-    Serial.write(c);
+    int room = Serial2.availableForWrite();
+
+    if (room < count)
+        count = room;
+
+    return count ? Serial2.write(data, count) : 0;
 }
 
 void Board::serialDebugByte(uint8_t c)
@@ -162,9 +254,37 @@ void Board::serialDebugByte(uint8_t c)
 
 void Board::writeMotor(uint8_t index, uint16_t pwmValue)
 { 
+#if MOTOR_DSHOT
+  dshotBits(dshotFrame(dshotThrottle(pwmValue), false, false), 
+      DSHOT_BIT_TICKS * 3 / 8, DSHOT_BIT_TICKS * 3 / 4, dshotBuffer[index], 1);
+#else
   uint8_t analogValue = map(pwmValue, CONFIG_PWM_MIN, CONFIG_PWM_MAX, 0, 255);
   
   analogWrite(MOTOR_PINS[index], analogValue);
+#endif
+}
+
+void Board::completeMotorUpdate(void)
+{
+#if MOTOR_DSHOT
+  for (int k=0; k<4; ++k) {
+    dshotDma[k].sourceBuffer(dshotBuffer[k], sizeof(dshotBuffer[k]));
+    dshotDma[k].enable();
+  }
+#endif
+}
+
+uint8_t Board::motorCount(void)
+{
+  return sizeof(MOTOR_PINS);
+}
+
+// no bidirectional DShot: the pins would have to be turned around to capture the ESC's reply
+bool Board::motorRpm(uint8_t index, uint16_t & rpm)
+{
+  (void)index;
+  (void)rpm;
+  return false;
 }
 
 // Unused -------------------------------------------------------------------------
@@ -210,6 +330,11 @@ void Board::showAuxStatus(uint8_t status)
 }
 
 
+uint16_t Board::batteryMillivolts(void)
+{
+    return 0;
+}
+
 bool Board::baroInit(void)
 {
   return false;
@@ -0,0 +1 @@
+../../firmware/dshot.cpp
\ No newline at end of file
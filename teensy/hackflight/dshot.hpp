@@ -0,0 +1 @@
+../../firmware/dshot.hpp
\ No newline at end of file
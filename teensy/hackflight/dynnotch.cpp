@@ -0,0 +1 @@
+../../firmware/dynnotch.cpp
\ No newline at end of file
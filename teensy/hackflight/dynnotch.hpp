@@ -0,0 +1 @@
+../../firmware/dynnotch.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../firmware/fastmath.cpp
\ No newline at end of file
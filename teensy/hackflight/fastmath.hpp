@@ -0,0 +1 @@
+../../firmware/fastmath.hpp
\ No newline at end of file
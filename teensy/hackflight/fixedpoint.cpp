@@ -0,0 +1 @@
+../../firmware/fixedpoint.cpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../firmware/fixedpoint.hpp
\ No newline at end of file
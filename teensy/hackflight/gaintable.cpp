@@ -0,0 +1 @@
+../../firmware/gaintable.cpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../firmware/gaintable.hpp
\ No newline at end of file
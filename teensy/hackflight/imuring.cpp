@@ -0,0 +1 @@
+../../firmware/imuring.cpp
\ No newline at end of file
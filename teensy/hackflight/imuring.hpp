@@ -0,0 +1 @@
+../../firmware/imuring.hpp
\ No newline at end of file
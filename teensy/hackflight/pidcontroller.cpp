@@ -0,0 +1 @@
+../../firmware/pidcontroller.cpp
\ No newline at end of file
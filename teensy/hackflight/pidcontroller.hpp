@@ -0,0 +1 @@
+../../firmware/pidcontroller.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../firmware/profiler.cpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../firmware/profiler.hpp
\ No newline at end of file
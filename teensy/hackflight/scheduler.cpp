@@ -0,0 +1 @@
+../../firmware/scheduler.cpp
\ No newline at end of file
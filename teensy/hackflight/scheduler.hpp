@@ -0,0 +1 @@
+../../firmware/scheduler.hpp
\ No newline at end of file